@@ -1558,6 +1558,7 @@ def mk_config():
             SLIBFLAGS = '-dynamiclib'
         elif sysname == 'Linux':
             CXXFLAGS       = '%s -fno-strict-aliasing -D_LINUX_' % CXXFLAGS
+            CPPFLAGS       = '%s -D_USE_THREAD_LOCAL' % CPPFLAGS
             OS_DEFINES     = '-D_LINUX'
             SO_EXT         = '.so'
             LDFLAGS        = '%s -lrt' % LDFLAGS
@@ -1565,6 +1566,7 @@ def mk_config():
             SLIBEXTRAFLAGS = '%s -lrt' % SLIBEXTRAFLAGS
         elif sysname == 'FreeBSD':
             CXXFLAGS       = '%s -fno-strict-aliasing -D_FREEBSD_' % CXXFLAGS
+            CPPFLAGS       = '%s -D_USE_THREAD_LOCAL' % CPPFLAGS
             OS_DEFINES     = '-D_FREEBSD_'
             SO_EXT         = '.so'
             LDFLAGS        = '%s -lrt' % LDFLAGS
@@ -1580,8 +1582,6 @@ def mk_config():
         if is64():
             CXXFLAGS     = '%s -fPIC' % CXXFLAGS
             CPPFLAGS     = '%s -D_AMD64_' % CPPFLAGS
-            if sysname == 'Linux':
-                CPPFLAGS = '%s -D_USE_THREAD_LOCAL' % CPPFLAGS
         if DEBUG_MODE:
             CPPFLAGS     = '%s -DZ3DEBUG' % CPPFLAGS
         if TRACE or DEBUG_MODE:
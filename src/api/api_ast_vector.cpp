@@ -22,6 +22,7 @@ Revision History:
 #include"api_ast_vector.h"
 #include"ast_translation.h"
 #include"ast_smt2_pp.h"
+#include"ast_binary.h"
 
 extern "C" {
 
@@ -137,4 +138,24 @@ extern "C" {
         Z3_CATCH_RETURN(0);
     }
 
+    void Z3_API Z3_ast_vector_save(Z3_context c, Z3_ast_vector v, Z3_string file_name) {
+        Z3_TRY;
+        LOG_Z3_ast_vector_save(c, v, file_name);
+        RESET_ERROR_CODE();
+        ast_ref_vector const & asts = to_ast_vector_ref(v);
+        ast_binary_write_file(mk_c(c)->m(), asts.size(), asts.c_ptr(), file_name);
+        Z3_CATCH;
+    }
+
+    Z3_ast_vector Z3_API Z3_ast_vector_load(Z3_context c, Z3_string file_name) {
+        Z3_TRY;
+        LOG_Z3_ast_vector_load(c, file_name);
+        RESET_ERROR_CODE();
+        Z3_ast_vector_ref * v = alloc(Z3_ast_vector_ref, mk_c(c)->m());
+        mk_c(c)->save_object(v);
+        ast_binary_read_file(mk_c(c)->m(), file_name, v->m_ast_vector);
+        RETURN_Z3(of_ast_vector(v));
+        Z3_CATCH_RETURN(0);
+    }
+
 };
@@ -474,6 +474,16 @@ extern "C" {
             return;
         }
         mk_c(c)->m().dec_ref(to_ast(a));
+        if (mk_c(c)->m().has_deferred_deletions())
+            mk_c(c)->m().collect(mk_c(c)->params().m_deferred_deletion);
+        Z3_CATCH;
+    }
+
+    void Z3_API Z3_context_collect(Z3_context c) {
+        Z3_TRY;
+        LOG_Z3_context_collect(c);
+        RESET_ERROR_CODE();
+        mk_c(c)->m().collect();
         Z3_CATCH;
     }
 
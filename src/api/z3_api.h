@@ -1341,6 +1341,7 @@ extern "C" {
         
           - proof  (Boolean)           Enable proof generation
           - debug_ref_count (Boolean)  Enable debug support for Z3_ast reference counting 
+          - deferred_deletion (unsigned) When different from 0, unused ASTs are queued and each #Z3_dec_ref deletes at most this number of them
           - trace  (Boolean)           Tracing support for VCC
           - trace_file_name (String)   Trace out file for VCC traces
           - timeout (unsigned)         default timeout (in milliseconds) used for solvers
@@ -1458,6 +1459,19 @@ extern "C" {
        def_API('Z3_dec_ref', VOID, (_in(CONTEXT), _in(AST)))
     */
     void Z3_API Z3_dec_ref(__in Z3_context c, __in Z3_ast a);
+
+    /**
+       \brief Delete the ASTs that are no longer referenced and are still queued for deletion.
+
+       When the context is created with the parameter \c deferred_deletion, 
+       ASTs whose reference counter reaches 0 are not deleted immediately. 
+       Each #Z3_dec_ref deletes a bounded number of queued ASTs, and this
+       function deletes all of them. It can be invoked at points where 
+       latency is not critical.
+
+       def_API('Z3_context_collect', VOID, (_in(CONTEXT),))
+    */
+    void Z3_API Z3_context_collect(__in Z3_context c);
 #endif
 
     /**
@@ -6211,6 +6225,29 @@ END_MLAPI_EXCLUDE
     */
     Z3_string Z3_API Z3_ast_vector_to_string(__in Z3_context c, __in Z3_ast_vector v);
 
+    /**
+       \brief Save the AST vector \c v to the given file using a compact binary format.
+       
+       Sorts, declarations, numerals and shared subterms are written once. The file
+       can be loaded using #Z3_ast_vector_load, and the Z3 shell accepts it as an
+       input file (extension \c .z3b) containing a set of assertions.
+
+       \remark Floating point and irrational algebraic numerals are not supported.
+
+       def_API('Z3_ast_vector_save', VOID, (_in(CONTEXT), _in(AST_VECTOR), _in(STRING)))
+    */
+    void Z3_API Z3_ast_vector_save(__in Z3_context c, __in Z3_ast_vector v, __in Z3_string file_name);
+
+    /**
+       \brief Load an AST vector saved using #Z3_ast_vector_save. 
+       
+       The file is mapped in memory, and the ASTs are created in the context \c c.
+       Loading is much faster than parsing the same ASTs in SMT 2.0 format.
+
+       def_API('Z3_ast_vector_load', AST_VECTOR, (_in(CONTEXT), _in(STRING)))
+    */
+    Z3_ast_vector Z3_API Z3_ast_vector_load(__in Z3_context c, __in Z3_string file_name);
+
     /*@}*/
 
     /**
@@ -1306,6 +1306,15 @@ ast_manager::ast_manager(ast_manager const & src, bool disable_proofs):
 }
 
 void ast_manager::init() {
+    m_concurrent = false;
+    m_defer_deletion = false;
+    for (unsigned i = 0; i < c_num_ast_shards; i++)
+        omp_init_lock(&m_shard_locks[i]);
+    omp_init_lock(&m_id_lock);
+    omp_init_lock(&m_alloc_lock);
+    omp_init_lock(&m_deferred_lock);
+    omp_init_lock(&m_stamp_lock);
+    omp_init_nest_lock(&m_plugin_lock);
     m_int_real_coercions = true;
     m_debug_ref_count = false;
     m_fresh_id = 0;
@@ -1350,27 +1359,30 @@ ast_manager::~ast_manager() {
         if (*it)
             (*it)->finalize();
     }
+    collect();
     it = m_plugins.begin();
     for (; it != end; ++it) {
         if (*it)
             dealloc(*it);
     }
     DEBUG_CODE({
-        if (!m_ast_table.empty()) 
-            std::cout << "ast_manager LEAKED: " << m_ast_table.size() << std::endl;
+        if (get_num_asts() != 0) 
+            std::cout << "ast_manager LEAKED: " << get_num_asts() << std::endl;
     });
 #if 1
     DEBUG_CODE({
-        ast_table::iterator it_a = m_ast_table.begin();
-        ast_table::iterator end_a = m_ast_table.end();
-        for (; it_a != end_a; ++it_a) {
-            ast* a = (*it_a);
-            std::cout << "Leaked: ";
-            if (is_sort(a)) {
-                std::cout << to_sort(a)->get_name() << "\n";
-            }
-            else {
-                std::cout << mk_ll_pp(a, *this, false);
+        for (unsigned s = 0; s < c_num_ast_shards; s++) {
+            ast_table::iterator it_a = m_ast_table[s].begin();
+            ast_table::iterator end_a = m_ast_table[s].end();
+            for (; it_a != end_a; ++it_a) {
+                ast* a = (*it_a);
+                std::cout << "Leaked: ";
+                if (is_sort(a)) {
+                    std::cout << to_sort(a)->get_name() << "\n";
+                }
+                else {
+                    std::cout << mk_ll_pp(a, *this, false);
+                }
             }
         }
     });
@@ -1384,6 +1396,14 @@ ast_manager::~ast_manager() {
         dealloc(m_trace_stream);
         m_trace_stream = 0;
     }
+    for (unsigned i = 0; i < c_num_ast_shards; i++)
+        omp_destroy_lock(&m_shard_locks[i]);
+    omp_destroy_lock(&m_id_lock);
+    omp_destroy_lock(&m_alloc_lock);
+    omp_destroy_lock(&m_deferred_lock);
+    omp_destroy_lock(&m_stamp_lock);
+    omp_destroy_nest_lock(&m_plugin_lock);
+    std::for_each(m_free_stamp_tables.begin(), m_free_stamp_tables.end(), delete_proc<expr_stamp_table>());
 }
 
 void ast_manager::set_cancel(bool f) {
@@ -1394,20 +1414,23 @@ void ast_manager::set_cancel(bool f) {
 
 void ast_manager::compact_memory() {
     m_alloc.consolidate();
-    unsigned capacity = m_ast_table.capacity();
-    if (capacity > 4*m_ast_table.size()) {
-        ast_table new_ast_table;           
-        ast_table::iterator it  = m_ast_table.begin();
-        ast_table::iterator end = m_ast_table.end();
-        for (; it != end; ++it) {
-            new_ast_table.insert(*it);
+    for (unsigned s = 0; s < c_num_ast_shards; s++) {
+        ast_table & table = m_ast_table[s];
+        unsigned capacity = table.capacity();
+        if (capacity > 4*table.size()) {
+            ast_table new_ast_table;           
+            ast_table::iterator it  = table.begin();
+            ast_table::iterator end = table.end();
+            for (; it != end; ++it) {
+                new_ast_table.insert(*it);
+            }
+            table.swap(new_ast_table);
+            IF_VERBOSE(10, verbose_stream() << "(ast-table :prev-capacity " << capacity 
+                       << " :capacity " << table.capacity() << " :size " << table.size() << ")\n";);
+        }
+        else if (s == 0 || !table.empty()) {
+            IF_VERBOSE(10, verbose_stream() << "(ast-table :capacity " << table.capacity() << " :size " << table.size() << ")\n";);
         }
-        m_ast_table.swap(new_ast_table);
-        IF_VERBOSE(10, verbose_stream() << "(ast-table :prev-capacity " << capacity 
-                   << " :capacity " << m_ast_table.capacity() << " :size " << m_ast_table.size() << ")\n";);
-    }
-    else {
-        IF_VERBOSE(10, verbose_stream() << "(ast-table :capacity " << m_ast_table.capacity() << " :size " << m_ast_table.size() << ")\n";);
     }
 }
 
@@ -1415,21 +1438,131 @@ void ast_manager::compress_ids() {
     ptr_vector<ast> asts;
     m_expr_id_gen.cleanup();
     m_decl_id_gen.cleanup(c_first_decl_id);
-    ast_table::iterator it  = m_ast_table.begin();
-    ast_table::iterator end = m_ast_table.end();
-    for (; it != end; ++it) {
-        ast * n = *it;
-        if (is_decl(n))
-            n->m_id = m_decl_id_gen.mk();
-        else
-            n->m_id = m_expr_id_gen.mk();
-        asts.push_back(n);
+    for (unsigned s = 0; s < c_num_ast_shards; s++) {
+        ast_table::iterator it  = m_ast_table[s].begin();
+        ast_table::iterator end = m_ast_table[s].end();
+        for (; it != end; ++it) {
+            ast * n = *it;
+            if (is_decl(n))
+                n->m_id = m_decl_id_gen.mk();
+            else
+                n->m_id = m_expr_id_gen.mk();
+            asts.push_back(n);
+        }
+        m_ast_table[s].finalize();
     }
-    m_ast_table.finalize();
     ptr_vector<ast>::iterator it2  = asts.begin();
     ptr_vector<ast>::iterator end2 = asts.end();
     for (; it2 != end2; ++it2)
-        m_ast_table.insert(*it2);
+        get_ast_table(*it2).insert(*it2);
+}
+
+unsigned ast_manager::get_num_asts() const {
+    unsigned r = 0;
+    for (unsigned s = 0; s < c_num_ast_shards; s++)
+        r += m_ast_table[s].size();
+    return r;
+}
+
+void ast_manager::enable_concurrency() {
+    if (m_concurrent)
+        return;
+    ptr_vector<ast> asts;
+    ast_table::iterator it  = m_ast_table[0].begin();
+    ast_table::iterator end = m_ast_table[0].end();
+    for (; it != end; ++it) 
+        asts.push_back(*it);
+    m_ast_table[0].finalize();
+    m_concurrent = true;
+    ptr_vector<ast>::iterator it2  = asts.begin();
+    ptr_vector<ast>::iterator end2 = asts.end();
+    for (; it2 != end2; ++it2)
+        get_ast_table(*it2).insert(*it2);
+    if (m_format_manager)
+        m_format_manager->enable_concurrency();
+}
+
+expr_stamp_table * ast_manager::acquire_stamp_table() {
+    expr_stamp_table * r = 0;
+    if (m_concurrent)
+        omp_set_lock(&m_stamp_lock);
+    if (!m_free_stamp_tables.empty()) {
+        r = m_free_stamp_tables.back();
+        m_free_stamp_tables.pop_back();
+    }
+    if (m_concurrent)
+        omp_unset_lock(&m_stamp_lock);
+    if (r == 0)
+        r = alloc(expr_stamp_table);
+    return r;
+}
+
+void ast_manager::release_stamp_table(expr_stamp_table * t) {
+    t->reset();
+    if (m_concurrent)
+        omp_set_lock(&m_stamp_lock);
+    m_free_stamp_tables.push_back(t);
+    if (m_concurrent)
+        omp_unset_lock(&m_stamp_lock);
+}
+
+void ast_manager::defer_delete_node(ast * n) {
+    SASSERT(m_concurrent);
+    omp_set_lock(&m_deferred_lock);
+    m_deferred_dels.push_back(n);
+    omp_unset_lock(&m_deferred_lock);
+}
+
+void ast_manager::enable_deferred_deletion(bool f) {
+    m_defer_deletion = f;
+    if (!f)
+        collect();
+}
+
+void ast_manager::collect(unsigned max_nodes) {
+    ptr_buffer<ast> worklist;
+    unsigned num_deleted = 0;
+    while (num_deleted < max_nodes) {
+        // A node may have been reused after its counter reached 0, and it may 
+        // occur more than once in m_deferred_dels. The nodes to be deleted are 
+        // first pinned to make sure they are not deleted while processing
+        // the other ones.
+        ptr_vector<ast>::iterator it  = m_deferred_dels.begin();
+        ptr_vector<ast>::iterator end = m_deferred_dels.end();
+        for (; it != end; ++it) {
+            ast * n = *it;
+            if (n->get_ref_count() == 0) {
+                n->inc_ref();
+                m_pinned_dels.push_back(n);
+            }
+        }
+        m_deferred_dels.reset();
+        if (m_pinned_dels.empty())
+            break;
+        while (!m_pinned_dels.empty() && num_deleted < max_nodes) {
+            ast * n = m_pinned_dels.back();
+            m_pinned_dels.pop_back();
+            n->dec_ref();
+            if (n->get_ref_count() != 0)
+                continue;
+            worklist.push_back(n);
+            while (!worklist.empty() && num_deleted < max_nodes) {
+                n = worklist.back();
+                worklist.pop_back();
+                delete_node_core(n, worklist);
+                num_deleted++;
+            }
+            // nodes that became unused after the bound was reached
+            ptr_buffer<ast>::iterator it2  = worklist.begin();
+            ptr_buffer<ast>::iterator end2 = worklist.end();
+            for (; it2 != end2; ++it2) {
+                (*it2)->inc_ref();
+                m_pinned_dels.push_back(*it2);
+            }
+            worklist.reset();
+        }
+    }
+    TRACE("ast_collect", tout << "deleted: " << num_deleted << ", pending: " << m_pinned_dels.size() + m_deferred_dels.size() << "\n";);
 }
 
 void ast_manager::raise_exception(char const * msg) {
@@ -1470,14 +1603,19 @@ void ast_manager::copy_families_plugins(ast_manager const & from) {
 void ast_manager::set_next_expr_id(unsigned id) {
     while (true) {
         id = m_expr_id_gen.set_next_id(id);
-        ast_table::iterator it  = m_ast_table.begin();
-        ast_table::iterator end = m_ast_table.end();
-        for (; it != end; ++it) {
-            ast * curr = *it;
-            if (curr->get_id() == id)
-                break;
+        bool in_use = false;
+        for (unsigned s = 0; !in_use && s < c_num_ast_shards; s++) {
+            ast_table::iterator it  = m_ast_table[s].begin();
+            ast_table::iterator end = m_ast_table[s].end();
+            for (; it != end; ++it) {
+                ast * curr = *it;
+                if (curr->get_id() == id) {
+                    in_use = true;
+                    break;
+                }
+            }
         }
-        if (it == end)
+        if (!in_use)
             return;
         // id is in use, move to the next one.
         id++; 
@@ -1551,24 +1689,26 @@ bool ast_manager::is_bool(expr const * n) const {
 
 #ifdef Z3DEBUG
 bool ast_manager::slow_not_contains(ast const * n) {
-    ast_table::iterator it  = m_ast_table.begin();
-    ast_table::iterator end = m_ast_table.end();
     unsigned num = 0;
-    for (; it != end; ++it) {
-        ast * curr = *it;
-        if (compare_nodes(curr, n)) {
-            TRACE("nondet_bug", 
-                  tout << "id1:   " << curr->get_id() << ", id2: " << n->get_id() << "\n";
-                  tout << "hash1: " << get_node_hash(curr) << ", hash2: " << get_node_hash(n) << "\n";);
-            return false;
+    for (unsigned s = 0; s < c_num_ast_shards; s++) {
+        ast_table::iterator it  = m_ast_table[s].begin();
+        ast_table::iterator end = m_ast_table[s].end();
+        for (; it != end; ++it) {
+            ast * curr = *it;
+            if (compare_nodes(curr, n)) {
+                TRACE("nondet_bug", 
+                      tout << "id1:   " << curr->get_id() << ", id2: " << n->get_id() << "\n";
+                      tout << "hash1: " << get_node_hash(curr) << ", hash2: " << get_node_hash(n) << "\n";);
+                return false;
+            }
+            SASSERT(!(is_app(n) && is_app(curr) &&
+                      to_app(n)->get_decl() == to_app(curr)->get_decl() &&
+                      to_app(n)->get_num_args() == 0 &&
+                      to_app(curr)->get_num_args() == 0));
+            num++;
         }
-        SASSERT(!(is_app(n) && is_app(curr) &&
-                  to_app(n)->get_decl() == to_app(curr)->get_decl() &&
-                  to_app(n)->get_num_args() == 0 &&
-                  to_app(curr)->get_num_args() == 0));
-        num++;
     }
-    SASSERT(num == m_ast_table.size());
+    SASSERT(m_concurrent || num == get_num_asts());
     return true;
 }
 #endif
@@ -1576,19 +1716,37 @@ bool ast_manager::slow_not_contains(ast const * n) {
 ast * ast_manager::register_node_core(ast * n) {
     unsigned h = get_node_hash(n); 
     n->m_hash = h;
+    if (!m_concurrent)
+        return register_node_core(n, m_ast_table[0]);
+    unsigned s = get_shard(h);
+    omp_set_lock(&m_shard_locks[s]);
+    ast * r;
+    try {
+        r = register_node_core(n, m_ast_table[s]);
+    }
+    catch (...) {
+        omp_unset_lock(&m_shard_locks[s]);
+        throw;
+    }
+    omp_unset_lock(&m_shard_locks[s]);
+    return r;
+}
+
+ast * ast_manager::register_node_core(ast * n, ast_table & table) {
+    unsigned h = n->m_hash;
 #ifdef Z3DEBUG
-    bool contains = m_ast_table.contains(n);
-    CASSERT("nondet_bug", contains || slow_not_contains(n));
+    bool contains = table.contains(n);
+    CASSERT("nondet_bug", m_concurrent || contains || slow_not_contains(n));
 #endif
 
 #if 0
     static unsigned counter = 0;
     counter++;
     if (counter % 100000 == 0)
-        verbose_stream() << "[ast-table] counter: " << counter << " collisions: " << m_ast_table.collisions() << " capacity: " << m_ast_table.capacity() << " size: " << m_ast_table.size() << "\n";
+        verbose_stream() << "[ast-table] counter: " << counter << " collisions: " << table.collisions() << " capacity: " << table.capacity() << " size: " << table.size() << "\n";
 #endif
 
-    ast * r = m_ast_table.insert_if_not_there(n);
+    ast * r = table.insert_if_not_there(n);
     SASSERT(r->m_hash == h);
     if (r != n) {
 #if 0
@@ -1598,7 +1756,7 @@ ast * ast_manager::register_node_core(ast * n) {
             verbose_stream() << "[ast-table] reused: " << reused << "\n";
 #endif
         SASSERT(contains);
-        SASSERT(m_ast_table.contains(n));
+        SASSERT(table.contains(n));
         if (is_func_decl(r) && to_func_decl(r)->get_range() != to_func_decl(n)->get_range()) {
             std::ostringstream buffer;
             buffer << "Recycling of declaration for the same name '" << to_func_decl(r)->get_name().str().c_str() << "'"
@@ -1610,10 +1768,17 @@ ast * ast_manager::register_node_core(ast * n) {
     }
     else {
         SASSERT(!contains);
-        SASSERT(m_ast_table.contains(n));
+        SASSERT(table.contains(n));
     }
 
-    n->m_id   = is_decl(n) ? m_decl_id_gen.mk() : m_expr_id_gen.mk();
+    if (m_concurrent) {
+        omp_set_lock(&m_id_lock);
+        n->m_id = is_decl(n) ? m_decl_id_gen.mk() : m_expr_id_gen.mk();
+        omp_unset_lock(&m_id_lock);
+    }
+    else {
+        n->m_id = is_decl(n) ? m_decl_id_gen.mk() : m_expr_id_gen.mk();
+    }
 
     TRACE("ast", tout << "Object " << n->m_id << " was created.\n";);
     TRACE("mk_var_bug", tout << "mk_ast: " << n->m_id << "\n";);
@@ -1708,85 +1873,97 @@ void ast_manager::delete_node(ast * n) {
     while (!worklist.empty()) {
         n = worklist.back();
         worklist.pop_back();
-		
-        TRACE("ast", tout << "Deleting object " << n->m_id << " " << n << "\n";);
-        CTRACE("del_quantifier", is_quantifier(n), tout << "deleting quantifier " << n->m_id << " " << n << "\n";);
-        TRACE("mk_var_bug", tout << "del_ast: " << n->m_id << "\n";);
-        TRACE("ast_delete_node", tout << mk_bounded_pp(n, *this) << "\n";);
+        delete_node_core(n, worklist);
+    }
+}
+
+/**
+   \brief Delete \c n, and store in \c worklist the children whose reference counter reached 0.
+*/
+void ast_manager::delete_node_core(ast * n, ptr_buffer<ast> & worklist) {
+    TRACE("ast", tout << "Deleting object " << n->m_id << " " << n << "\n";);
+    CTRACE("del_quantifier", is_quantifier(n), tout << "deleting quantifier " << n->m_id << " " << n << "\n";);
+    TRACE("mk_var_bug", tout << "del_ast: " << n->m_id << "\n";);
+    TRACE("ast_delete_node", tout << mk_bounded_pp(n, *this) << "\n";);
 
-        SASSERT(m_ast_table.contains(n));
-        m_ast_table.erase(n);
-        SASSERT(!m_ast_table.contains(n));
-        SASSERT(!m_debug_ref_count || !m_debug_free_indices.contains(n->m_id));
+    SASSERT(contains(n));
+    get_ast_table(n).erase(n);
+    SASSERT(!contains(n));
+    SASSERT(!m_debug_ref_count || !m_debug_free_indices.contains(n->m_id));
 
 #ifdef RECYCLE_FREE_AST_INDICES
-        if (!m_debug_ref_count) {
-            if (is_decl(n))
-                m_decl_id_gen.recycle(n->m_id);
-            else 
-                m_expr_id_gen.recycle(n->m_id);
-        }
+    if (!m_debug_ref_count) {
+        if (is_decl(n))
+            m_decl_id_gen.recycle(n->m_id);
+        else 
+            m_expr_id_gen.recycle(n->m_id);
+    }
 #endif
-        switch (n->get_kind()) {
-        case AST_SORT:
-            if (to_sort(n)->m_info != 0 && !m_debug_ref_count) { 
-                sort_info * info = to_sort(n)->get_info();
-                info->del_eh(*this);
-                dealloc(info); 
-            }
-            break;
-        case AST_FUNC_DECL:
-            if (to_func_decl(n)->m_info != 0 && !m_debug_ref_count) { 
-                func_decl_info * info = to_func_decl(n)->get_info();
-                info->del_eh(*this);
-                dealloc(info);
-            }
-            dec_array_ref(worklist, to_func_decl(n)->get_arity(), to_func_decl(n)->get_domain());
-            dec_ref(worklist, to_func_decl(n)->get_range());
-            break;
-        case AST_APP:
-            dec_ref(worklist, to_app(n)->get_decl());
-            dec_array_ref(worklist, to_app(n)->get_num_args(), to_app(n)->get_args());
-            break;
-        case AST_VAR:
-            dec_ref(worklist, to_var(n)->get_sort());
-            break;
-        case AST_QUANTIFIER:
-            dec_array_ref(worklist, to_quantifier(n)->get_num_decls(), to_quantifier(n)->get_decl_sorts());
-            dec_ref(worklist, to_quantifier(n)->get_expr());
-            dec_array_ref(worklist, to_quantifier(n)->get_num_patterns(), to_quantifier(n)->get_patterns());
-            dec_array_ref(worklist, to_quantifier(n)->get_num_no_patterns(), to_quantifier(n)->get_no_patterns());
-            break;
-	default:
-	    break;
+    switch (n->get_kind()) {
+    case AST_SORT:
+        if (to_sort(n)->m_info != 0 && !m_debug_ref_count) { 
+            sort_info * info = to_sort(n)->get_info();
+            info->del_eh(*this);
+            dealloc(info); 
         }
-        if (m_debug_ref_count) {
-            m_debug_free_indices.insert(n->m_id,0);
+        break;
+    case AST_FUNC_DECL:
+        if (to_func_decl(n)->m_info != 0 && !m_debug_ref_count) { 
+            func_decl_info * info = to_func_decl(n)->get_info();
+            info->del_eh(*this);
+            dealloc(info);
         }
-        deallocate_node(n, ::get_node_size(n));
+        dec_array_ref(worklist, to_func_decl(n)->get_arity(), to_func_decl(n)->get_domain());
+        dec_ref(worklist, to_func_decl(n)->get_range());
+        break;
+    case AST_APP:
+        dec_ref(worklist, to_app(n)->get_decl());
+        dec_array_ref(worklist, to_app(n)->get_num_args(), to_app(n)->get_args());
+        break;
+    case AST_VAR:
+        dec_ref(worklist, to_var(n)->get_sort());
+        break;
+    case AST_QUANTIFIER:
+        dec_array_ref(worklist, to_quantifier(n)->get_num_decls(), to_quantifier(n)->get_decl_sorts());
+        dec_ref(worklist, to_quantifier(n)->get_expr());
+        dec_array_ref(worklist, to_quantifier(n)->get_num_patterns(), to_quantifier(n)->get_patterns());
+        dec_array_ref(worklist, to_quantifier(n)->get_num_no_patterns(), to_quantifier(n)->get_no_patterns());
+        break;
+    default:
+        break;
+    }
+    if (m_debug_ref_count) {
+        m_debug_free_indices.insert(n->m_id,0);
     }
+    deallocate_node(n, ::get_node_size(n));
 }
 
 sort * ast_manager::mk_sort(family_id fid, decl_kind k, unsigned num_parameters, parameter const * parameters) {
     decl_plugin * p = get_plugin(fid);
-    if (p)
+    if (p) {
+        plugin_lock lock(*this);
         return p->mk_sort(k, num_parameters, parameters);
+    }
     return 0;
 }
     
 func_decl * ast_manager::mk_func_decl(family_id fid, decl_kind k, unsigned num_parameters, parameter const * parameters,
                                       unsigned arity, sort * const * domain, sort * range) {
     decl_plugin * p = get_plugin(fid);
-    if (p)
+    if (p) {
+        plugin_lock lock(*this);
         return p->mk_func_decl(k, num_parameters, parameters, arity, domain, range);
+    }
     return 0;
 }
 
 func_decl * ast_manager::mk_func_decl(family_id fid, decl_kind k, unsigned num_parameters, parameter const * parameters, 
                                       unsigned num_args, expr * const * args, sort * range) {
     decl_plugin * p = get_plugin(fid);
-    if (p)
+    if (p) {
+        plugin_lock lock(*this);
         return p->mk_func_decl(k, num_parameters, parameters, num_args, args, range);
+    }
     return 0;
 } 
 
@@ -2064,8 +2241,9 @@ func_decl * ast_manager::mk_fresh_func_decl(symbol const & prefix, symbol const
     info.m_skolem = true;
     SASSERT(info.is_skolem());
     func_decl * d;
+    unsigned id = mk_fresh_id();
     if (prefix == symbol::null && suffix == symbol::null) {
-        d = mk_func_decl(symbol(m_fresh_id), arity, domain, range, &info);
+        d = mk_func_decl(symbol(id), arity, domain, range, &info);
     }
     else {
         string_buffer<64> buffer;
@@ -2075,10 +2253,9 @@ func_decl * ast_manager::mk_fresh_func_decl(symbol const & prefix, symbol const
         buffer << "!";
         if (suffix != symbol::null)
             buffer << suffix << "!";
-        buffer << m_fresh_id;
+        buffer << id;
         d = mk_func_decl(symbol(buffer.c_str()), arity, domain, range, &info);
     }
-    m_fresh_id++;
     SASSERT(d->get_info());
     SASSERT(d->is_skolem());
     return d;
@@ -2086,15 +2263,13 @@ func_decl * ast_manager::mk_fresh_func_decl(symbol const & prefix, symbol const
 
 sort * ast_manager::mk_fresh_sort(char const * prefix) {
     string_buffer<32> buffer;
-    buffer << prefix << "!" << m_fresh_id;
-    m_fresh_id++;
+    buffer << prefix << "!" << mk_fresh_id();
     return mk_uninterpreted_sort(symbol(buffer.c_str()));
 }
 
 symbol ast_manager::mk_fresh_var_name(char const * prefix) {
     string_buffer<32> buffer;
-    buffer << (prefix ? prefix : "var") << "!" << m_fresh_id;
-    m_fresh_id++;
+    buffer << (prefix ? prefix : "var") << "!" << mk_fresh_id();
     return symbol(buffer.c_str());
 }
 
@@ -2394,6 +2569,7 @@ expr * ast_manager::get_some_value(sort * s) {
     if (fid != null_family_id) {
         decl_plugin * p = get_plugin(fid);
         if (p != 0) {
+            plugin_lock lock(*this);
             v = p->get_some_value(s);
             if (v != 0)
                 return v;
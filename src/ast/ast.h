@@ -44,6 +44,8 @@ Revision History:
 #include"chashtable.h"
 #include"z3_exception.h"
 #include"dependency.h"
+#include"z3_omp.h"
+#include"z3_atomic.h"
 
 #define RECYCLE_FREE_AST_INDICES
 
@@ -410,8 +412,6 @@ std::ostream & operator<<(std::ostream & out, func_decl_info const & info);
 typedef enum { AST_APP, AST_VAR, AST_QUANTIFIER, AST_SORT, AST_FUNC_DECL } ast_kind;
 char const * get_ast_kind_name(ast_kind k);
 
-class shared_occs_mark;
-
 class ast {
 protected:
     friend class ast_manager;
@@ -421,20 +421,6 @@ protected:
     // Warning: the marks should be used carefully, since they are shared.
     unsigned m_mark1:1;
     unsigned m_mark2:1;
-    // Private mark used by shared_occs functor
-    // Motivation for this field:
-    //  - A mark cannot be used by more than one owner.
-    //    So, it is only safe to use mark by "self-contained" code.
-    //    They should be viewed as temporary information.
-    //  - The functor shared_occs is used by some AST pretty printers.
-    //  - So, a code that uses marks could not use the pretty printer if 
-    //    shared_occs used one of the public marks.
-    //  - This was a constant source of assertion violations.
-    unsigned m_mark_shared_occs:1; 
-    friend class shared_occs_mark;
-    void mark_so(bool flag) { m_mark_shared_occs = flag; }
-    void reset_mark_so() { m_mark_shared_occs = false; }
-    bool is_marked_so() const { return m_mark_shared_occs; }
     unsigned m_ref_count;
     unsigned m_hash;
 #ifdef Z3DEBUG
@@ -452,8 +438,18 @@ protected:
         SASSERT(m_ref_count > 0); 
         m_ref_count --; 
     }
+
+    void inc_ref_atomic() { 
+        SASSERT(m_ref_count < UINT_MAX);
+        atomic_inc(&m_ref_count);
+    }
+
+    unsigned dec_ref_atomic() { 
+        SASSERT(m_ref_count > 0); 
+        return atomic_dec(&m_ref_count);
+    }
     
-    ast(ast_kind k):m_id(UINT_MAX), m_kind(k), m_mark1(false), m_mark2(false), m_mark_shared_occs(false), m_ref_count(0) {
+    ast(ast_kind k):m_id(UINT_MAX), m_kind(k), m_mark1(false), m_mark2(false), m_ref_count(0) {
         DEBUG_CODE({
             m_mark1_owner = 0;
             m_mark2_owner = 0;
@@ -893,6 +889,9 @@ public:
     void erase(ast * n);
 };
 
+// Number of hash-consing tables used by an ast_manager in concurrent mode (must be a power of two).
+const unsigned c_num_ast_shards = 16;
+
 // -----------------------------------
 //
 // decl_plugin
@@ -1359,6 +1358,35 @@ public:
     virtual expr * operator()(sort * s) = 0;
 };
 
+// -----------------------------------
+//
+// expr_stamp_table
+//
+// -----------------------------------
+
+/**
+   \brief Dense table of generation stamps indexed by expression id.
+   An expression is marked iff its stamp is the current generation,
+   so the table is reset in constant time by moving to the next generation.
+*/
+class expr_stamp_table {
+    unsigned_vector m_stamps;
+    unsigned        m_gen;
+public:
+    expr_stamp_table():m_gen(1) {}
+    bool is_marked(unsigned id) const { return id < m_stamps.size() && m_stamps[id] == m_gen; }
+    void mark(unsigned id) { m_stamps.setx(id, m_gen, 0); }
+    void unmark(unsigned id) { if (id < m_stamps.size()) m_stamps[id] = 0; }
+    void reset() {
+        m_gen++;
+        if (m_gen == 0) {
+            // the generation wrapped around
+            m_stamps.fill(0);
+            m_gen = 1;
+        }
+    }
+};
+
 // -----------------------------------
 //
 // Proof generation mode
@@ -1435,9 +1463,21 @@ protected:
     family_id                 m_model_value_family_id;
     family_id                 m_user_sort_family_id;
     family_id                 m_arith_family_id;
-    ast_table                 m_ast_table;       
+    // In sequential mode only the first shard is used.
+    ast_table                 m_ast_table[c_num_ast_shards];
     id_gen                    m_expr_id_gen;
     id_gen                    m_decl_id_gen;
+    bool                      m_concurrent;
+    omp_lock_t                m_shard_locks[c_num_ast_shards];
+    omp_lock_t                m_id_lock;
+    omp_lock_t                m_alloc_lock;
+    omp_lock_t                m_deferred_lock;
+    omp_lock_t                m_stamp_lock;
+    omp_nest_lock_t           m_plugin_lock;
+    ptr_vector<expr_stamp_table> m_free_stamp_tables; // tables not used by any expr_dense_mark
+    bool                      m_defer_deletion;
+    ptr_vector<ast>           m_deferred_dels;   // nodes whose reference counter reached 0 in concurrent or deferred deletion mode
+    ptr_vector<ast>           m_pinned_dels;     // nodes waiting to be deleted by #collect, each one holds a reference
     sort *                    m_bool_sort;
     sort *                    m_proof_sort;
     app *                     m_true;
@@ -1455,6 +1495,14 @@ protected:
 
     void init();
 
+    unsigned get_shard(unsigned h) const { return m_concurrent ? (h & (c_num_ast_shards - 1)) : 0; }
+
+    ast_table & get_ast_table(ast const * n) { return m_ast_table[get_shard(n->hash())]; }
+
+    ast_table const & get_ast_table(ast const * n) const { return m_ast_table[get_shard(n->hash())]; }
+
+    unsigned mk_fresh_id() { return m_concurrent ? atomic_inc(&m_fresh_id) - 1 : m_fresh_id++; }
+
     bool coercion_needed(func_decl * decl, unsigned num_args, expr * const * args);
 
 public:
@@ -1553,22 +1601,93 @@ public:
     
     bool are_distinct(expr * a, expr * b) const;
     
-    bool contains(ast * a) const { return m_ast_table.contains(a); }
+    bool contains(ast * a) const { return get_ast_table(a).contains(a); }
     
-    unsigned get_num_asts() const { return m_ast_table.size(); }
+    unsigned get_num_asts() const;
+
+    /**
+       \brief Switch the manager to concurrent mode. 
+       
+       In concurrent mode, several threads may create and reference expressions
+       in the same manager: the hash-consing table is split into shards protected
+       by their own locks, reference counters are updated atomically, and the
+       generation of ids and the node allocator are protected by locks. 
+       Declarations produced by plugins are created while holding a plugin lock.
+
+       Nodes whose reference counter reaches 0 are not deleted immediately since
+       another thread may be about to reuse them. They are deleted by #collect.
+
+       Marks stored in the nodes (mark1, mark2, shared occurrences), the array
+       and dependency managers, and decl_plugin methods invoked directly (without
+       going through the manager) are not protected.
+
+       \pre This method must be invoked before other threads use the manager.
+    */
+    void enable_concurrency();
+
+    bool concurrent() const { return m_concurrent; }
+
+    /**
+       \brief Enable/disable deferred deletion. 
+
+       When enabled, nodes whose reference counter reaches 0 are queued instead of
+       being deleted with all the nodes they (transitively) own. The queued nodes 
+       are deleted by #collect. Disabling deferred deletion deletes the queued nodes.
+    */
+    void enable_deferred_deletion(bool f);
+
+    bool deferred_deletion() const { return m_defer_deletion; }
+
+    /**
+       \brief Return true if there are nodes waiting to be deleted by #collect.
+    */
+    bool has_deferred_deletions() const { return !m_deferred_dels.empty() || !m_pinned_dels.empty(); }
+
+    /**
+       \brief Delete at most \c max_nodes of the nodes whose reference counter reached 0 
+       while in concurrent or deferred deletion mode. The nodes that become unused 
+       and could not be deleted within this bound are kept for the next invocation.
+
+       \pre No other thread is using the manager.
+    */
+    void collect(unsigned max_nodes = UINT_MAX);
+
+    /**
+       \brief Return a stamp table with no marked expressions. The table must be
+       given back using #release_stamp_table. 
+       
+       Tables are reused, so a traversal using one does not need to allocate or 
+       clear memory proportional to the number of expressions.
+    */
+    expr_stamp_table * acquire_stamp_table();
+
+    void release_stamp_table(expr_stamp_table * t);
 
     void debug_ref_count() { m_debug_ref_count = true; }
     
     void inc_ref(ast * n) { 
-        if (n)
-            n->inc_ref();
+        if (n) {
+            if (m_concurrent)
+                n->inc_ref_atomic();
+            else
+                n->inc_ref();
+        }
     }
     
     void dec_ref(ast * n) {
         if (n) {
+            if (m_concurrent) {
+                if (n->dec_ref_atomic() == 0)
+                    defer_delete_node(n);
+                return;
+            }
             n->dec_ref();
-            if (n->get_ref_count() == 0)
-                delete_node(n);
+            if (n->get_ref_count() == 0) {
+                if (m_defer_deletion)
+                    m_deferred_dels.push_back(n);
+                else
+                    delete_node(n);
+            }
         }
     }
     
@@ -1594,6 +1713,23 @@ public:
     
 protected:
     ast * register_node_core(ast * n);
+
+    ast * register_node_core(ast * n, ast_table & table);
+
+    class plugin_lock;
+    friend class plugin_lock;
+    class plugin_lock {
+        ast_manager & m_manager;
+    public:
+        plugin_lock(ast_manager & m):m_manager(m) { 
+            if (m_manager.m_concurrent) 
+                omp_set_nest_lock(&m_manager.m_plugin_lock); 
+        }
+        ~plugin_lock() { 
+            if (m_manager.m_concurrent) 
+                omp_unset_nest_lock(&m_manager.m_plugin_lock); 
+        }
+    };
     
     template<typename T>
     T * register_node(T * n) { 
@@ -1601,12 +1737,28 @@ protected:
     }
     
     void delete_node(ast * n);
+
+    void delete_node_core(ast * n, ptr_buffer<ast> & worklist);
+
+    void defer_delete_node(ast * n);
     
     void * allocate_node(unsigned size) { 
+        if (m_concurrent) {
+            omp_set_lock(&m_alloc_lock);
+            void * r = m_alloc.allocate(size);
+            omp_unset_lock(&m_alloc_lock);
+            return r;
+        }
         return m_alloc.allocate(size);
     }
     
     void deallocate_node(ast * n, unsigned sz) {
+        if (m_concurrent) {
+            omp_set_lock(&m_alloc_lock);
+            m_alloc.deallocate(sz, n);
+            omp_unset_lock(&m_alloc_lock);
+            return;
+        }
         m_alloc.deallocate(sz, n);
     }
     
@@ -2254,6 +2406,24 @@ typedef app_ref_buffer                proof_ref_buffer;
 
 typedef obj_mark<expr> expr_mark;
 
+/**
+   \brief Expression mark backed by a stamp table of the manager.
+   It is cheap to create, and to reset, independently of the number of
+   marked expressions. It does not use the marks stored in the nodes,
+   so it can be nested with other marks.
+*/
+class expr_dense_mark {
+    ast_manager &      m_manager;
+    expr_stamp_table * m_table;
+public:
+    expr_dense_mark(ast_manager & m):m_manager(m), m_table(m.acquire_stamp_table()) {}
+    ~expr_dense_mark() { m_manager.release_stamp_table(m_table); }
+    bool is_marked(expr const * n) const { return m_table->is_marked(n->get_id()); }
+    void mark(expr const * n) { m_table->mark(n->get_id()); }
+    void mark(expr const * n, bool flag) { if (flag) mark(n); else m_table->unmark(n->get_id()); }
+    void reset() { m_table->reset(); }
+};
+
 class expr_sparse_mark {
     obj_hashtable<expr> m_marked;
 public:
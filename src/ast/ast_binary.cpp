@@ -0,0 +1,834 @@
+/*++
+Copyright (c) 2015 Microsoft Corporation
+
+Module Name:
+
+    ast_binary.cpp
+
+Abstract:
+
+    Compact binary format for expression DAGs.
+
+    Layout:
+       header     "Z3AB" version
+       symbols    <num> (<tag> [<unsigned> | <chars> 0])*
+       asts       <num> <record>*
+       roots      <num> <ref>*
+
+    Unsigned integers use 7 bits per byte (LEB128), signed integers are
+    zigzag encoded, and a reference to an AST is the difference between
+    the position of the AST being defined and the position of the
+    referenced AST. Function declarations are also numbered separately,
+    and applications refer to them by number, since a few declarations
+    are typically shared by many applications far apart in the file.
+    Applications with few arguments store the number of arguments in
+    the record tag. Strings are 0-terminated, so symbols can be created
+    directly from a memory mapped file.
+
+Author:
+
+Revision History:
+
+--*/
+#include<fstream>
+#include"ast_binary.h"
+#include"map.h"
+#include"z3_exception.h"
+#ifdef _WINDOWS
+#include<windows.h>
+#else
+#include<sys/types.h>
+#include<sys/stat.h>
+#include<sys/mman.h>
+#include<fcntl.h>
+#include<unistd.h>
+#endif
+
+#define AST_BINARY_VERSION 1
+
+static char const g_ast_binary_magic[4] = { 'Z', '3', 'A', 'B' };
+
+namespace ast_binary {
+
+    enum symbol_tag {
+        SYM_NULL,
+        SYM_NUM,
+        SYM_STR
+    };
+
+    enum record_tag {
+        REC_UNINTERP_SORT,  // name params
+        REC_SORT,           // name family kind params size-kind [size] private
+        REC_FUNC_DECL,      // name arity domain* range
+        REC_FUNC_DECL_INFO, // name family kind params flags arity domain* range
+        REC_APP,            // decl-num num-args args*
+        REC_VAR,            // idx sort
+        REC_QUANTIFIER,     // forall weight qid skid num-decls (sort name)* body num-patterns patterns* num-no-patterns no-patterns*
+        REC_APP_0           // REC_APP_0 + n: decl-num args*, for n < c_max_small_app
+    };
+
+    const unsigned c_max_small_app = 8;
+
+    enum sort_size_tag {
+        SZ_FINITE,
+        SZ_VERY_BIG,
+        SZ_INFINITE
+    };
+
+    enum rational_tag {
+        RAT_INT64,
+        RAT_STRING
+    };
+
+    enum decl_flag {
+        F_LEFT_ASSOC  = 1,
+        F_RIGHT_ASSOC = 2,
+        F_FLAT_ASSOC  = 4,
+        F_COMMUTATIVE = 8,
+        F_CHAINABLE   = 16,
+        F_PAIRWISE    = 32,
+        F_INJECTIVE   = 64,
+        F_IDEMPOTENT  = 128,
+        F_SKOLEM      = 256
+    };
+
+    typedef svector<unsigned char> bytes;
+
+    class writer {
+        typedef map<symbol, unsigned, symbol_hash_proc, symbol_eq_proc> sym2idx;
+        ast_manager &   m;
+        bytes           m_syms;     // symbol section
+        bytes           m_asts;     // AST section
+        unsigned        m_num_syms;
+        unsigned        m_num_asts;
+        unsigned        m_num_decls;
+        sym2idx         m_sym2idx;
+        unsigned_vector m_decl2idx; // declaration id -> position + 1, 0 if not written yet
+        unsigned_vector m_expr2idx; // expression id -> position + 1, 0 if not written yet
+        unsigned_vector m_decl2num; // declaration id -> number of the function declaration
+        ptr_vector<ast> m_todo;
+
+        static void write_unsigned(bytes & out, uint64 v) {
+            while (v >= 0x80) {
+                out.push_back(static_cast<unsigned char>(v | 0x80));
+                v >>= 7;
+            }
+            out.push_back(static_cast<unsigned char>(v));
+        }
+
+        static void write_int(bytes & out, int64 v) {
+            write_unsigned(out, (static_cast<uint64>(v) << 1) ^ static_cast<uint64>(v >> 63));
+        }
+
+        static void write_string(bytes & out, char const * s) {
+            for (; *s; ++s)
+                out.push_back(static_cast<unsigned char>(*s));
+            out.push_back(0);
+        }
+
+        void write_unsigned(uint64 v) { write_unsigned(m_asts, v); }
+
+        void write_int(int64 v) { write_int(m_asts, v); }
+
+        void write_symbol(symbol const & s) {
+            unsigned idx;
+            if (!m_sym2idx.find(s, idx)) {
+                idx = m_num_syms++;
+                m_sym2idx.insert(s, idx);
+                if (s == symbol::null) {
+                    m_syms.push_back(SYM_NULL);
+                }
+                else if (s.is_numerical()) {
+                    m_syms.push_back(SYM_NUM);
+                    write_unsigned(m_syms, s.get_num());
+                }
+                else {
+                    m_syms.push_back(SYM_STR);
+                    write_string(m_syms, s.bare_str());
+                }
+            }
+            write_unsigned(idx);
+        }
+
+        unsigned & get_idx(ast * n) {
+            unsigned_vector & v = is_decl(n) ? m_decl2idx : m_expr2idx;
+            unsigned id = is_decl(n) ? to_decl(n)->get_decl_id() : n->get_id();
+            if (id >= v.size())
+                v.resize(id + 1, 0);
+            return v[id];
+        }
+
+        bool is_written(ast * n) { return get_idx(n) != 0; }
+
+        void write_ref(ast * n) {
+            SASSERT(is_written(n));
+            write_unsigned(m_num_asts - (get_idx(n) - 1));
+        }
+
+        void write_family(family_id fid) {
+            write_symbol(fid == null_family_id ? symbol::null : m.get_family_name(fid));
+        }
+
+        void write_parameters(unsigned num, parameter const * ps) {
+            write_unsigned(num);
+            for (unsigned i = 0; i < num; i++) {
+                parameter const & p = ps[i];
+                m_asts.push_back(static_cast<unsigned char>(p.get_kind()));
+                switch (p.get_kind()) {
+                case parameter::PARAM_INT:
+                    write_int(p.get_int());
+                    break;
+                case parameter::PARAM_AST:
+                    write_ref(p.get_ast());
+                    break;
+                case parameter::PARAM_SYMBOL:
+                    write_symbol(p.get_symbol());
+                    break;
+                case parameter::PARAM_RATIONAL: {
+                    rational const & r = p.get_rational();
+                    if (r.is_int64()) {
+                        m_asts.push_back(RAT_INT64);
+                        write_int(r.get_int64());
+                    }
+                    else {
+                        m_asts.push_back(RAT_STRING);
+                        write_string(m_asts, r.to_string().c_str());
+                    }
+                    break;
+                }
+                case parameter::PARAM_DOUBLE: {
+                    double d = p.get_double();
+                    unsigned char const * b = reinterpret_cast<unsigned char const *>(&d);
+                    for (unsigned j = 0; j < sizeof(double); j++)
+                        m_asts.push_back(b[j]);
+                    break;
+                }
+                default:
+                    throw default_exception("binary AST format does not support external parameters");
+                }
+            }
+        }
+
+        void push_parameters(unsigned num, parameter const * ps) {
+            for (unsigned i = 0; i < num; i++) {
+                if (ps[i].is_ast() && !is_written(ps[i].get_ast()))
+                    m_todo.push_back(ps[i].get_ast());
+            }
+        }
+
+        void push(ast * n) {
+            if (!is_written(n))
+                m_todo.push_back(n);
+        }
+
+        void push_children(ast * n) {
+            switch (n->get_kind()) {
+            case AST_SORT:
+                push_parameters(to_sort(n)->get_num_parameters(), to_sort(n)->get_parameters());
+                break;
+            case AST_FUNC_DECL: {
+                func_decl * f = to_func_decl(n);
+                push_parameters(f->get_num_parameters(), f->get_parameters());
+                for (unsigned i = 0; i < f->get_arity(); i++)
+                    push(f->get_domain(i));
+                push(f->get_range());
+                break;
+            }
+            case AST_APP: {
+                app * a = to_app(n);
+                push(a->get_decl());
+                for (unsigned i = 0; i < a->get_num_args(); i++)
+                    push(a->get_arg(i));
+                break;
+            }
+            case AST_VAR:
+                push(to_var(n)->get_sort());
+                break;
+            case AST_QUANTIFIER: {
+                quantifier * q = to_quantifier(n);
+                for (unsigned i = 0; i < q->get_num_decls(); i++)
+                    push(q->get_decl_sort(i));
+                for (unsigned i = 0; i < q->get_num_children(); i++)
+                    push(q->get_child(i));
+                break;
+            }
+            default:
+                UNREACHABLE();
+            }
+        }
+
+        void write_sort(sort * s) {
+            if (m.is_uninterp(s)) {
+                m_asts.push_back(REC_UNINTERP_SORT);
+                write_symbol(s->get_name());
+                write_parameters(s->get_num_parameters(), s->get_parameters());
+                return;
+            }
+            sort_info * info = s->get_info();
+            m_asts.push_back(REC_SORT);
+            write_symbol(s->get_name());
+            write_family(info->get_family_id());
+            write_int(info->get_decl_kind());
+            write_parameters(info->get_num_parameters(), info->get_parameters());
+            sort_size const & sz = info->get_num_elements();
+            if (sz.is_finite()) {
+                m_asts.push_back(SZ_FINITE);
+                write_unsigned(sz.size());
+            }
+            else {
+                m_asts.push_back(sz.is_very_big() ? SZ_VERY_BIG : SZ_INFINITE);
+            }
+            m_asts.push_back(info->private_parameters());
+        }
+
+        void write_func_decl(func_decl * f) {
+            func_decl_info * info = f->get_info();
+            if (info == 0) {
+                m_asts.push_back(REC_FUNC_DECL);
+                write_symbol(f->get_name());
+            }
+            else {
+                m_asts.push_back(REC_FUNC_DECL_INFO);
+                write_symbol(f->get_name());
+                write_family(info->get_family_id());
+                write_int(info->get_decl_kind());
+                write_parameters(info->get_num_parameters(), info->get_parameters());
+                unsigned flags = 0;
+                if (info->is_left_associative())  flags |= F_LEFT_ASSOC;
+                if (info->is_right_associative()) flags |= F_RIGHT_ASSOC;
+                if (info->is_flat_associative())  flags |= F_FLAT_ASSOC;
+                if (info->is_commutative())       flags |= F_COMMUTATIVE;
+                if (info->is_chainable())         flags |= F_CHAINABLE;
+                if (info->is_pairwise())          flags |= F_PAIRWISE;
+                if (info->is_injective())         flags |= F_INJECTIVE;
+                if (info->is_idempotent())        flags |= F_IDEMPOTENT;
+                if (info->is_skolem())            flags |= F_SKOLEM;
+                write_unsigned(flags);
+            }
+            write_unsigned(f->get_arity());
+            for (unsigned i = 0; i < f->get_arity(); i++)
+                write_ref(f->get_domain(i));
+            write_ref(f->get_range());
+            unsigned id = f->get_decl_id();
+            m_decl2num.reserve(id + 1, 0);
+            m_decl2num[id] = m_num_decls++;
+        }
+
+        void write_node(ast * n) {
+            switch (n->get_kind()) {
+            case AST_SORT:
+                write_sort(to_sort(n));
+                break;
+            case AST_FUNC_DECL:
+                write_func_decl(to_func_decl(n));
+                break;
+            case AST_APP: {
+                app * a = to_app(n);
+                unsigned num = a->get_num_args();
+                if (num < c_max_small_app) {
+                    m_asts.push_back(static_cast<unsigned char>(REC_APP_0 + num));
+                    write_unsigned(m_decl2num[a->get_decl()->get_decl_id()]);
+                }
+                else {
+                    m_asts.push_back(REC_APP);
+                    write_unsigned(m_decl2num[a->get_decl()->get_decl_id()]);
+                    write_unsigned(num);
+                }
+                for (unsigned i = 0; i < a->get_num_args(); i++)
+                    write_ref(a->get_arg(i));
+                break;
+            }
+            case AST_VAR:
+                m_asts.push_back(REC_VAR);
+                write_unsigned(to_var(n)->get_idx());
+                write_ref(to_var(n)->get_sort());
+                break;
+            case AST_QUANTIFIER: {
+                quantifier * q = to_quantifier(n);
+                m_asts.push_back(REC_QUANTIFIER);
+                m_asts.push_back(q->is_forall());
+                write_int(q->get_weight());
+                write_symbol(q->get_qid());
+                write_symbol(q->get_skid());
+                write_unsigned(q->get_num_decls());
+                for (unsigned i = 0; i < q->get_num_decls(); i++) {
+                    write_ref(q->get_decl_sort(i));
+                    write_symbol(q->get_decl_name(i));
+                }
+                write_ref(q->get_expr());
+                write_unsigned(q->get_num_patterns());
+                for (unsigned i = 0; i < q->get_num_patterns(); i++)
+                    write_ref(q->get_pattern(i));
+                write_unsigned(q->get_num_no_patterns());
+                for (unsigned i = 0; i < q->get_num_no_patterns(); i++)
+                    write_ref(q->get_no_pattern(i));
+                break;
+            }
+            default:
+                UNREACHABLE();
+            }
+            m_num_asts++;
+            get_idx(n) = m_num_asts;
+        }
+
+        void process(ast * r) {
+            m_todo.push_back(r);
+            while (!m_todo.empty()) {
+                ast * n = m_todo.back();
+                if (is_written(n)) {
+                    m_todo.pop_back();
+                    continue;
+                }
+                unsigned sz = m_todo.size();
+                push_children(n);
+                if (sz == m_todo.size()) {
+                    m_todo.pop_back();
+                    write_node(n);
+                }
+            }
+        }
+
+    public:
+        writer(ast_manager & m):m(m), m_num_syms(0), m_num_asts(0), m_num_decls(0) {}
+
+        void operator()(unsigned num_roots, ast * const * roots, std::ostream & out) {
+            for (unsigned i = 0; i < num_roots; i++)
+                process(roots[i]);
+            bytes header;
+            for (unsigned i = 0; i < sizeof(g_ast_binary_magic); i++)
+                header.push_back(g_ast_binary_magic[i]);
+            write_unsigned(header, AST_BINARY_VERSION);
+            write_unsigned(header, m_num_syms);
+            out.write(reinterpret_cast<char const *>(header.c_ptr()), header.size());
+            out.write(reinterpret_cast<char const *>(m_syms.c_ptr()), m_syms.size());
+            bytes roots_section;
+            write_unsigned(roots_section, m_num_asts);
+            out.write(reinterpret_cast<char const *>(roots_section.c_ptr()), roots_section.size());
+            out.write(reinterpret_cast<char const *>(m_asts.c_ptr()), m_asts.size());
+            roots_section.reset();
+            write_unsigned(roots_section, num_roots);
+            for (unsigned i = 0; i < num_roots; i++)
+                write_unsigned(roots_section, m_num_asts - (get_idx(roots[i]) - 1));
+            out.write(reinterpret_cast<char const *>(roots_section.c_ptr()), roots_section.size());
+        }
+    };
+
+    class reader {
+        static const family_id c_unknown_fid = null_family_id - 1;
+        ast_manager &         m;
+        unsigned char const * m_curr;
+        unsigned char const * m_end;
+        vector<symbol>        m_syms;
+        svector<family_id>    m_sym2fid;  // family of the symbol at the given position, or c_unknown_fid
+        ast_ref_vector        m_asts;
+        ptr_vector<func_decl> m_decls;    // function declarations in m_asts, by number
+        buffer<parameter>     m_params;
+        ptr_buffer<ast>       m_args;
+        buffer<symbol>        m_names;
+
+        void throw_invalid() {
+            throw default_exception("invalid binary AST file");
+        }
+
+        unsigned char read_byte() {
+            if (m_curr == m_end)
+                throw_invalid();
+            return *m_curr++;
+        }
+
+        uint64 read_uint64() {
+            uint64 r = 0;
+            unsigned shift = 0;
+            while (true) {
+                unsigned char b = read_byte();
+                if (shift > 63)
+                    throw_invalid();
+                r |= static_cast<uint64>(b & 0x7f) << shift;
+                if (b < 0x80)
+                    return r;
+                shift += 7;
+            }
+        }
+
+        unsigned read_unsigned() {
+            // fast path for the common case of a single byte
+            if (m_curr != m_end && *m_curr < 0x80)
+                return *m_curr++;
+            uint64 r = read_uint64();
+            if (r > UINT_MAX)
+                throw_invalid();
+            return static_cast<unsigned>(r);
+        }
+
+        int64 read_int64() {
+            uint64 v = read_uint64();
+            return static_cast<int64>(v >> 1) ^ -static_cast<int64>(v & 1);
+        }
+
+        int read_int() {
+            int64 v = read_int64();
+            if (v < INT_MIN || v > INT_MAX)
+                throw_invalid();
+            return static_cast<int>(v);
+        }
+
+        char const * read_string() {
+            char const * r = reinterpret_cast<char const *>(m_curr);
+            while (read_byte() != 0)
+                ;
+            return r;
+        }
+
+        symbol const & read_symbol() {
+            unsigned idx = read_unsigned();
+            if (idx >= m_syms.size())
+                throw_invalid();
+            return m_syms[idx];
+        }
+
+        family_id read_family() {
+            unsigned idx = read_unsigned();
+            if (idx >= m_syms.size())
+                throw_invalid();
+            family_id & fid = m_sym2fid[idx];
+            if (fid == c_unknown_fid) {
+                symbol const & s = m_syms[idx];
+                if (s == symbol::null) {
+                    fid = null_family_id;
+                }
+                else {
+                    fid = m.get_family_id(s);
+                    if (fid == null_family_id)
+                        throw default_exception("binary AST file uses unknown family '%s'", s.str().c_str());
+                }
+            }
+            return fid;
+        }
+
+        ast * read_ref() {
+            unsigned delta = read_unsigned();
+            if (delta == 0 || delta > m_asts.size())
+                throw_invalid();
+            return m_asts.get(m_asts.size() - delta);
+        }
+
+        sort * read_sort() {
+            ast * n = read_ref();
+            if (!is_sort(n))
+                throw_invalid();
+            return to_sort(n);
+        }
+
+        expr * read_expr() {
+            ast * n = read_ref();
+            if (!is_expr(n))
+                throw_invalid();
+            return to_expr(n);
+        }
+
+        void read_parameters() {
+            m_params.reset();
+            unsigned num = read_unsigned();
+            for (unsigned i = 0; i < num; i++) {
+                switch (read_byte()) {
+                case parameter::PARAM_INT:
+                    m_params.push_back(parameter(read_int()));
+                    break;
+                case parameter::PARAM_AST:
+                    m_params.push_back(parameter(read_ref()));
+                    break;
+                case parameter::PARAM_SYMBOL:
+                    m_params.push_back(parameter(read_symbol()));
+                    break;
+                case parameter::PARAM_RATIONAL:
+                    if (read_byte() == RAT_INT64)
+                        m_params.push_back(parameter(rational(read_int64(), rational::i64())));
+                    else
+                        m_params.push_back(parameter(rational(read_string())));
+                    break;
+                case parameter::PARAM_DOUBLE: {
+                    double d;
+                    if (static_cast<size_t>(m_end - m_curr) < sizeof(double))
+                        throw_invalid();
+                    memcpy(&d, m_curr, sizeof(double));
+                    m_curr += sizeof(double);
+                    m_params.push_back(parameter(d));
+                    break;
+                }
+                default:
+                    throw_invalid();
+                }
+            }
+        }
+
+        void read_header() {
+            for (unsigned i = 0; i < sizeof(g_ast_binary_magic); i++) {
+                if (read_byte() != static_cast<unsigned char>(g_ast_binary_magic[i]))
+                    throw_invalid();
+            }
+            if (read_unsigned() != AST_BINARY_VERSION)
+                throw default_exception("unsupported version of the binary AST format");
+        }
+
+        void read_symbols() {
+            unsigned num = read_unsigned();
+            for (unsigned i = 0; i < num; i++) {
+                switch (read_byte()) {
+                case SYM_NULL:
+                    m_syms.push_back(symbol::null);
+                    break;
+                case SYM_NUM:
+                    m_syms.push_back(symbol(read_unsigned()));
+                    break;
+                case SYM_STR:
+                    m_syms.push_back(symbol(read_string()));
+                    break;
+                default:
+                    throw_invalid();
+                }
+            }
+            m_sym2fid.resize(num, c_unknown_fid);
+        }
+
+        void read_domain(unsigned arity) {
+            m_args.reset();
+            for (unsigned i = 0; i < arity; i++)
+                m_args.push_back(read_sort());
+        }
+
+        ast * read_sort_record(bool uninterp) {
+            symbol name = read_symbol();
+            if (uninterp) {
+                read_parameters();
+                return m.mk_uninterpreted_sort(name, m_params.size(), m_params.c_ptr());
+            }
+            family_id fid = read_family();
+            decl_kind k   = read_int();
+            read_parameters();
+            sort_size sz;
+            switch (read_byte()) {
+            case SZ_FINITE:
+                sz = sort_size::mk_finite(read_uint64());
+                break;
+            case SZ_VERY_BIG:
+                sz = sort_size::mk_very_big();
+                break;
+            case SZ_INFINITE:
+                sz = sort_size::mk_infinite();
+                break;
+            default:
+                throw_invalid();
+            }
+            bool private_parameters = read_byte() != 0;
+            return m.mk_sort(name, sort_info(fid, k, sz, m_params.size(), m_params.c_ptr(), private_parameters));
+        }
+
+        ast * read_func_decl_record(bool has_info) {
+            symbol name = read_symbol();
+            if (!has_info) {
+                read_domain(read_unsigned());
+                sort * range = read_sort();
+                return m.mk_func_decl(name, m_args.size(), reinterpret_cast<sort * const *>(m_args.c_ptr()), range);
+            }
+            family_id fid = read_family();
+            decl_kind k   = read_int();
+            read_parameters();
+            unsigned flags = read_unsigned();
+            func_decl_info info(fid, k, m_params.size(), m_params.c_ptr());
+            info.set_left_associative((flags & F_LEFT_ASSOC) != 0);
+            info.set_right_associative((flags & F_RIGHT_ASSOC) != 0);
+            info.set_flat_associative((flags & F_FLAT_ASSOC) != 0);
+            info.set_commutative((flags & F_COMMUTATIVE) != 0);
+            info.set_chainable((flags & F_CHAINABLE) != 0);
+            info.set_pairwise((flags & F_PAIRWISE) != 0);
+            info.set_injective((flags & F_INJECTIVE) != 0);
+            info.set_idempotent((flags & F_IDEMPOTENT) != 0);
+            info.set_skolem((flags & F_SKOLEM) != 0);
+            read_domain(read_unsigned());
+            sort * range = read_sort();
+            return m.mk_func_decl(name, m_args.size(), reinterpret_cast<sort * const *>(m_args.c_ptr()), range, info);
+        }
+
+        ast * read_app_record(bool small, unsigned num) {
+            unsigned idx = read_unsigned();
+            if (idx >= m_decls.size())
+                throw_invalid();
+            if (!small)
+                num = read_unsigned();
+            m_args.reset();
+            for (unsigned i = 0; i < num; i++)
+                m_args.push_back(read_expr());
+            return m.mk_app(m_decls[idx], num, reinterpret_cast<expr * const *>(m_args.c_ptr()));
+        }
+
+        ast * read_quantifier_record() {
+            bool forall = read_byte() != 0;
+            int weight  = read_int();
+            symbol qid  = read_symbol();
+            symbol skid = read_symbol();
+            unsigned num_decls = read_unsigned();
+            m_args.reset();
+            m_names.reset();
+            for (unsigned i = 0; i < num_decls; i++) {
+                m_args.push_back(read_sort());
+                m_names.push_back(read_symbol());
+            }
+            m_args.push_back(read_expr());
+            unsigned num_patterns = read_unsigned();
+            for (unsigned i = 0; i < num_patterns; i++)
+                m_args.push_back(read_expr());
+            unsigned num_no_patterns = read_unsigned();
+            for (unsigned i = 0; i < num_no_patterns; i++)
+                m_args.push_back(read_expr());
+            ast * const * args = m_args.c_ptr();
+            return m.mk_quantifier(forall, num_decls, reinterpret_cast<sort * const *>(args), m_names.c_ptr(),
+                                   static_cast<expr*>(args[num_decls]), weight, qid, skid,
+                                   num_patterns, reinterpret_cast<expr * const *>(args + num_decls + 1),
+                                   num_no_patterns, reinterpret_cast<expr * const *>(args + num_decls + 1 + num_patterns));
+        }
+
+        void read_asts() {
+            unsigned num = read_unsigned();
+            m_asts.reserve(num);
+            for (unsigned i = 0; i < num; i++) {
+                ast * n = 0;
+                unsigned char tag = read_byte();
+                if (tag >= REC_APP_0) {
+                    if (tag >= REC_APP_0 + c_max_small_app)
+                        throw_invalid();
+                    m_asts.push_back(read_app_record(true, tag - REC_APP_0));
+                    continue;
+                }
+                switch (tag) {
+                case REC_UNINTERP_SORT:  n = read_sort_record(true); break;
+                case REC_SORT:           n = read_sort_record(false); break;
+                case REC_FUNC_DECL:
+                case REC_FUNC_DECL_INFO:
+                    n = read_func_decl_record(tag == REC_FUNC_DECL_INFO);
+                    m_decls.push_back(to_func_decl(n));
+                    break;
+                case REC_APP:            n = read_app_record(false, 0); break;
+                case REC_VAR: {
+                    unsigned idx = read_unsigned();
+                    n = m.mk_var(idx, read_sort());
+                    break;
+                }
+                case REC_QUANTIFIER:     n = read_quantifier_record(); break;
+                default:
+                    throw_invalid();
+                }
+                m_asts.push_back(n);
+            }
+        }
+
+    public:
+        reader(ast_manager & m, char const * data, size_t sz):
+            m(m),
+            m_curr(reinterpret_cast<unsigned char const *>(data)),
+            m_end(reinterpret_cast<unsigned char const *>(data) + sz),
+            m_asts(m) {
+        }
+
+        void operator()(ast_ref_vector & result) {
+            read_header();
+            read_symbols();
+            read_asts();
+            unsigned num_roots = read_unsigned();
+            for (unsigned i = 0; i < num_roots; i++)
+                result.push_back(read_ref());
+            if (m_curr != m_end)
+                throw_invalid();
+        }
+    };
+
+    /**
+       \brief Read-only view of a file mapped in memory.
+    */
+    class mapped_file {
+        char const * m_data;
+        size_t       m_size;
+#ifdef _WINDOWS
+        HANDLE       m_file;
+        HANDLE       m_mapping;
+#endif
+    public:
+        mapped_file(char const * file_name):m_data(0), m_size(0) {
+#ifdef _WINDOWS
+            m_mapping = 0;
+            m_file    = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+            if (m_file == INVALID_HANDLE_VALUE)
+                throw z3_error(ERR_OPEN_FILE);
+            LARGE_INTEGER sz;
+            if (GetFileSizeEx(m_file, &sz) && sz.QuadPart > 0) {
+                m_size    = static_cast<size_t>(sz.QuadPart);
+                m_mapping = CreateFileMappingA(m_file, 0, PAGE_READONLY, 0, 0, 0);
+                if (m_mapping != 0)
+                    m_data = static_cast<char const *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+            }
+#else
+            int fd = open(file_name, O_RDONLY);
+            if (fd < 0)
+                throw z3_error(ERR_OPEN_FILE);
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0) {
+                m_size = static_cast<size_t>(st.st_size);
+                void * p = mmap(0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED)
+                    m_data = static_cast<char const *>(p);
+            }
+            ::close(fd);
+#endif
+            if (m_data == 0) {
+                release();
+                throw z3_error(ERR_OPEN_FILE);
+            }
+        }
+
+        ~mapped_file() { release(); }
+
+        char const * data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        void release() {
+#ifdef _WINDOWS
+            if (m_data)
+                UnmapViewOfFile(m_data);
+            if (m_mapping)
+                CloseHandle(m_mapping);
+            CloseHandle(m_file);
+#else
+            if (m_data)
+                munmap(const_cast<char *>(m_data), m_size);
+#endif
+            m_data = 0;
+        }
+    };
+
+};
+
+void ast_binary_write(ast_manager & m, unsigned num_roots, ast * const * roots, std::ostream & out) {
+    ast_binary::writer w(m);
+    w(num_roots, roots, out);
+}
+
+void ast_binary_read(ast_manager & m, char const * data, size_t sz, ast_ref_vector & result) {
+    ast_binary::reader r(m, data, sz);
+    r(result);
+}
+
+bool is_ast_binary(char const * data, size_t sz) {
+    return sz >= sizeof(g_ast_binary_magic) && memcmp(data, g_ast_binary_magic, sizeof(g_ast_binary_magic)) == 0;
+}
+
+void ast_binary_write_file(ast_manager & m, unsigned num_roots, ast * const * roots, char const * file_name) {
+    std::ofstream out(file_name, std::ios::out | std::ios::binary);
+    if (out.bad() || out.fail())
+        throw z3_error(ERR_OPEN_FILE);
+    ast_binary_write(m, num_roots, roots, out);
+}
+
+void ast_binary_read_file(ast_manager & m, char const * file_name, ast_ref_vector & result) {
+    ast_binary::mapped_file f(file_name);
+    ast_binary_read(m, f.data(), f.size(), result);
+}
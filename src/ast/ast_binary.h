@@ -0,0 +1,58 @@
+/*++
+Copyright (c) 2015 Microsoft Corporation
+
+Module Name:
+
+    ast_binary.h
+
+Abstract:
+
+    Compact binary format for expression DAGs.
+
+    A file contains a table of symbols followed by the sorts, declarations
+    and expressions reachable from a sequence of roots, in topological
+    order. Every symbol and every (shared) AST is written once. Integers
+    are stored using a variable length encoding, and references to ASTs
+    are stored relative to the position of the AST being defined.
+
+Author:
+
+Revision History:
+
+--*/
+#ifndef _AST_BINARY_H_
+#define _AST_BINARY_H_
+
+#include<iostream>
+#include"ast.h"
+
+/**
+   \brief Write \c roots, and all ASTs they depend on, to \c out.
+
+   An exception is thrown if a declaration has an external parameter
+   (e.g., floating point or irrational algebraic numerals).
+*/
+void ast_binary_write(ast_manager & m, unsigned num_roots, ast * const * roots, std::ostream & out);
+
+/**
+   \brief Read the ASTs written by #ast_binary_write from the buffer [data, data + sz),
+   and append the roots to \c result.
+
+   The buffer does not need to outlive this function. An exception is thrown if
+   the buffer is not well formed, or the ASTs use a family that is not registered in \c m.
+*/
+void ast_binary_read(ast_manager & m, char const * data, size_t sz, ast_ref_vector & result);
+
+/**
+   \brief Return true if the buffer [data, data + sz) starts with the header of the binary format.
+*/
+bool is_ast_binary(char const * data, size_t sz);
+
+void ast_binary_write_file(ast_manager & m, unsigned num_roots, ast * const * roots, char const * file_name);
+
+/**
+   \brief Map the given file in memory, and read it using #ast_binary_read.
+*/
+void ast_binary_read_file(ast_manager & m, char const * file_name, ast_ref_vector & result);
+
+#endif /* _AST_BINARY_H_ */
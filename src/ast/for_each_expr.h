@@ -128,6 +128,21 @@ void for_each_expr(ForEachProc & proc, expr * n) {
     for_each_expr_core<ForEachProc, expr_mark, false, false>(proc, visited, n);
 }
 
+template<typename ForEachProc>
+void for_each_expr(ForEachProc & proc, expr_dense_mark & visited, expr * n) {
+    for_each_expr_core<ForEachProc, expr_dense_mark, true, false>(proc, visited, n);
+}
+
+/**
+   \brief Similar to for_each_expr(proc, n), but the visited expressions are 
+   tracked using an expr_dense_mark of \c m.
+*/
+template<typename ForEachProc>
+void for_each_expr(ForEachProc & proc, ast_manager & m, expr * n) {
+    expr_dense_mark visited(m);
+    for_each_expr_core<ForEachProc, expr_dense_mark, false, false>(proc, visited, n);
+}
+
 template<typename ForEachProc>
 void quick_for_each_expr(ForEachProc & proc, expr_fast_mark1 & visited, expr * n) {
     for_each_expr_core<ForEachProc, expr_fast_mark1, false, false>(proc, visited, n);
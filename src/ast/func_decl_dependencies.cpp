@@ -50,7 +50,7 @@ struct collect_dependencies_proc {
 
 void collect_func_decls(ast_manager & m, expr * n, func_decl_set & r, bool ng_only) {
     collect_dependencies_proc proc(m, r, ng_only);
-    for_each_expr(proc, n);
+    for_each_expr(proc, m, n);
 }
 
 void func_decl_dependencies::reset() {
@@ -23,13 +23,30 @@ Revision History:
 class contains_vars {
     typedef hashtable<expr_delta_pair, obj_hash<expr_delta_pair>, default_eq<expr_delta_pair> > cache;
     cache                    m_cache;
+    expr_dense_mark *        m_visited; // if not 0, pairs (n, m_begin) are cached here instead of m_cache
     svector<expr_delta_pair> m_todo;
     bool                     m_contains;
     unsigned                 m_window;
+    unsigned                 m_begin;
+
+    bool is_cached(expr_delta_pair const & e) const {
+        if (m_visited && e.m_delta == m_begin)
+            return m_visited->is_marked(e.m_node);
+        return m_cache.contains(e);
+    }
+
+    void insert_cache(expr_delta_pair const & e) {
+        if (m_visited && e.m_delta == m_begin)
+            m_visited->mark(e.m_node);
+        else
+            m_cache.insert(e);
+    }
 
     void visit(expr * n, unsigned delta, bool & visited) {
+        if (is_app(n) && to_app(n)->is_ground())
+            return;
         expr_delta_pair e(n, delta);
-        if (!m_cache.contains(e)) {
+        if (!is_cached(e)) {
             m_todo.push_back(e);
             visited = false;
         }
@@ -64,17 +81,22 @@ class contains_vars {
     }
 
 public:
+    contains_vars(expr_dense_mark * visited = 0):m_visited(visited) {}
+
     // return true if n contains a variable in the range [begin, end]
     bool operator()(expr * n, unsigned begin = 0, unsigned end = UINT_MAX) {
         m_contains   = false;
         m_window     = end - begin;
+        m_begin      = begin;
         m_todo.reset();
         m_cache.reset();
+        if (m_visited)
+            m_visited->reset();
         m_todo.push_back(expr_delta_pair(n, begin));
         while (!m_todo.empty()) {
             expr_delta_pair e = m_todo.back();
             if (visit_children(e.m_node, e.m_delta)) {
-                m_cache.insert(e);
+                insert_cache(e);
                 m_todo.pop_back();
             }
             if (m_contains) {
@@ -91,4 +113,10 @@ bool has_free_vars(expr * n) {
     return p(n);
 }
 
+bool has_free_vars(ast_manager & m, expr * n) {
+    expr_dense_mark visited(m);
+    contains_vars p(&visited);
+    return p(n);
+}
+
 
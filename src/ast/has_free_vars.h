@@ -20,8 +20,15 @@ Revision History:
 #define _HAS_FREE_VARS_H_
 
 class expr;
+class ast_manager;
 
 bool has_free_vars(expr * n);
 
+/**
+   \brief Similar to has_free_vars(n), but expressions that do not occur below a quantifier
+   are tracked using an expr_dense_mark of \c m instead of a hashtable.
+*/
+bool has_free_vars(ast_manager & m, expr * n);
+
 #endif /* _HAS_FREE_VARS_H_ */
 
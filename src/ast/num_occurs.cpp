@@ -19,7 +19,7 @@ Revision History:
 
 #include"num_occurs.h"
 
-void num_occurs::process(expr * t, expr_fast_mark1 & visited) {
+void num_occurs::process(expr * t, expr_dense_mark & visited) {
     ptr_buffer<expr, 128> stack;
     
 #define VISIT(ARG) {                                                                                    \
@@ -61,12 +61,12 @@ void num_occurs::process(expr * t, expr_fast_mark1 & visited) {
 }
 
 void num_occurs::operator()(expr * t) {
-    expr_fast_mark1   visited;
+    expr_dense_mark visited(m);
     process(t, visited);
 }
 
 void num_occurs::operator()(unsigned num, expr * const * ts) {
-    expr_fast_mark1   visited;
+    expr_dense_mark visited(m);
     for (unsigned i = 0; i < num; i++) {
         process(ts[i], visited);
     }
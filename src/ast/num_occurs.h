@@ -27,13 +27,15 @@ Revision History:
 */
 class num_occurs { 
 protected:
+    ast_manager &                  m;
     bool m_ignore_ref_count1;
     bool m_ignore_quantifiers;
     obj_map<expr, unsigned>        m_num_occurs;
 
-    void process(expr * t, expr_fast_mark1 & visited);
+    void process(expr * t, expr_dense_mark & visited);
 public:
-    num_occurs(bool ignore_ref_count1 = false, bool ignore_quantifiers = false):
+    num_occurs(ast_manager & _m, bool ignore_ref_count1 = false, bool ignore_quantifiers = false):
+        m(_m),
         m_ignore_ref_count1(ignore_ref_count1), 
         m_ignore_quantifiers(ignore_quantifiers) {
     }
@@ -41,7 +41,7 @@ shared_occs::~shared_occs() {
     reset();
 }
 
-inline bool shared_occs::process(expr * t, shared_occs_mark & visited) {
+inline bool shared_occs::process(expr * t, expr_dense_mark & visited) {
     switch (t->get_kind()) {
     case AST_APP: {
         unsigned num_args = to_app(t)->get_num_args();
@@ -83,7 +83,7 @@ inline bool shared_occs::process(expr * t, shared_occs_mark & visited) {
     }
 }
 
-void shared_occs::operator()(expr * t, shared_occs_mark & visited) {
+void shared_occs::operator()(expr * t, expr_dense_mark & visited) {
     SASSERT(m_stack.empty());
     if (process(t, visited)) {
         return;
@@ -126,7 +126,7 @@ void shared_occs::operator()(expr * t, shared_occs_mark & visited) {
 
 void shared_occs::operator()(expr * t) {
     SASSERT(m_stack.empty());
-    shared_occs_mark visited;
+    expr_dense_mark visited(m);
     reset();
     operator()(t, visited);
 }
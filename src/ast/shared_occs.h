@@ -22,29 +22,6 @@ Revision History:
 #include"ast.h"
 #include"obj_hashtable.h"
 
-class shared_occs_mark {
-    ptr_buffer<ast> m_to_unmark;
-public:
-    shared_occs_mark() {}
- 
-    ~shared_occs_mark() {
-        reset();
-    }
-    
-    bool is_marked(ast * n) { return n->is_marked_so(); }
-    void reset_mark(ast * n) { n->reset_mark_so(); }
-    void mark(ast * n) { if (is_marked(n)) return; n->mark_so(true); m_to_unmark.push_back(n); }
-    void reset() {
-        ptr_buffer<ast>::iterator it  = m_to_unmark.begin();
-        ptr_buffer<ast>::iterator end = m_to_unmark.end();
-        for (; it != end; ++it) {
-            reset_mark(*it);
-        }
-        m_to_unmark.reset();
-    }
-    void mark(ast * n, bool flag) { if (flag) mark(n); else reset_mark(n); } 
-};
-
 /**
    \brief Functor for computing the shared subterms in a given term.
 */
@@ -56,7 +33,7 @@ class shared_occs {
     obj_hashtable<expr> m_shared;
     typedef std::pair<expr*, unsigned> frame;
     svector<frame>      m_stack;
-    bool process(expr * t, shared_occs_mark & visited);
+    bool process(expr * t, expr_dense_mark & visited);
     void insert(expr * t);
 public:
     typedef obj_hashtable<expr>::iterator iterator;
@@ -68,7 +45,7 @@ public:
     }
     ~shared_occs();
     void operator()(expr * t);
-    void operator()(expr * t, shared_occs_mark & visited);
+    void operator()(expr * t, expr_dense_mark & visited);
     bool is_shared(expr * t) const { return m_shared.contains(t); }
     unsigned num_shared() const { return m_shared.size(); }
     iterator begin_shared() const { return m_shared.begin(); }
@@ -76,7 +76,7 @@ bool simplify_inj_axiom(ast_manager & m, quantifier * q, expr_ref & result) {
                         return false;
                     }
                 }
-                if (found_vars && !has_free_vars(q)) {
+                if (found_vars && !has_free_vars(m, q)) {
                     TRACE("inj_axiom", 
                           tout << "Cadidate for simplification:\n" << mk_ll_pp(q, m) << mk_pp(app1, m) << "\n" << mk_pp(app2, m) << "\n" <<
                           mk_pp(var1, m) << "\n" << mk_pp(var2, m) << "\nnum_vars: " << num_vars << "\n";);
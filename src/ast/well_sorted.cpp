@@ -76,7 +76,7 @@ struct well_sorted_proc {
 
 bool is_well_sorted(ast_manager const & m, expr * n) {
     well_sorted_proc p(const_cast<ast_manager&>(m));
-    for_each_expr(p, n);
+    for_each_expr(p, const_cast<ast_manager&>(m), n);
     return !p.m_error;
 }
 
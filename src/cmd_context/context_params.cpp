@@ -82,6 +82,10 @@ void context_params::set(char const * param, char const * value) {
     else if (p == "debug_ref_count") {
         set_bool(m_debug_ref_count, param, value);
     }
+    else if (p == "deferred_deletion") {
+        long val = strtol(value, 0, 10);
+        m_deferred_deletion = static_cast<unsigned>(val);
+    }
     else if (p == "smtlib2_compliant") {
         set_bool(m_smtlib2_compliant, param, value);
     }
@@ -106,6 +110,7 @@ void context_params::updt_params(params_ref const & p) {
     m_trace_file_name   = p.get_str("trace_file_name", "z3.log");
     m_unsat_core        = p.get_bool("unsat_core", false);
     m_debug_ref_count   = p.get_bool("debug_ref_count", false);
+    m_deferred_deletion = p.get_uint("deferred_deletion", 0);
     m_smtlib2_compliant = p.get_bool("smtlib2_compliant", false);
 }
 
@@ -122,6 +127,7 @@ void context_params::collect_param_descrs(param_descrs & d) {
     d.insert("trace_file_name", CPK_STRING, "trace out file name (see option 'trace')", "z3.log");
     d.insert("unsat_core", CPK_BOOL, "unsat-core generation for solvers, this parameter can be overwritten when creating a solver, not every solver in Z3 supports unsat core generation", "false");
     d.insert("debug_ref_count", CPK_BOOL, "debug support for AST reference counting", "false");
+    d.insert("deferred_deletion", CPK_UINT, "when different from 0, unused ASTs are queued instead of being deleted immediately, and each Z3_dec_ref deletes at most this number of queued ASTs (see Z3_context_collect)", "0");
     d.insert("smtlib2_compliant", CPK_BOOL, "enable/disable SMT-LIB 2.0 compliance", "false");
 }
 
@@ -151,6 +157,8 @@ ast_manager * context_params::mk_ast_manager() {
         r->enable_int_real_coercions(false);
     if (m_debug_ref_count)
         r->debug_ref_count();
+    if (m_deferred_deletion > 0)
+        r->enable_deferred_deletion(true);
     return r;
 }
 
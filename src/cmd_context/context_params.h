@@ -32,6 +32,7 @@ public:
     bool        m_interpolants;
     bool        m_check_interpolants;
     bool        m_debug_ref_count;
+    unsigned    m_deferred_deletion;
     bool        m_trace;
     std::string m_trace_file_name;
     bool        m_well_sorted_check;
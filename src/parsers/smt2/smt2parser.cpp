@@ -872,7 +872,7 @@ namespace smt2 {
 
         void name_expr(expr * n, symbol const & s) {
             TRACE("name_expr", tout << "naming: " << s << " ->\n" << mk_pp(n, m()) << "\n";);
-            if (!is_ground(n) && has_free_vars(n))
+            if (!is_ground(n) && has_free_vars(m(), n))
                 throw parser_exception("invalid named expression, expression contains free variables");
             m_ctx.insert(s, 0, n);
             m_last_named_expr.first  = s;
@@ -35,7 +35,7 @@ Revision History:
 #include"gparams.h"
 #include"env_params.h"
 
-typedef enum { IN_UNSPECIFIED, IN_SMTLIB, IN_SMTLIB_2, IN_DATALOG, IN_DIMACS, IN_Z3_LOG } input_kind;
+typedef enum { IN_UNSPECIFIED, IN_SMTLIB, IN_SMTLIB_2, IN_DATALOG, IN_DIMACS, IN_Z3_LOG, IN_AST_BINARY } input_kind;
 
 std::string         g_aux_input_file;
 char const *        g_input_file          = 0;
@@ -73,6 +73,7 @@ void display_usage() {
     std::cout << "  -dl         use parser for Datalog input format.\n";
     std::cout << "  -dimacs     use parser for DIMACS input format.\n";
     std::cout << "  -log        use parser for Z3 log input format.\n";
+    std::cout << "  -bin        use reader for Z3 binary AST format (see Z3_ast_vector_save).\n";
     std::cout << "  -in         read formula from standard input.\n";
     std::cout << "\nMiscellaneous:\n";
     std::cout << "  -h, -?      prints this message.\n";
@@ -171,6 +172,9 @@ void parse_cmd_line_args(int argc, char ** argv) {
             else if (strcmp(opt_name, "log") == 0) {
                 g_input_kind = IN_Z3_LOG;
             }
+            else if (strcmp(opt_name, "bin") == 0) {
+                g_input_kind = IN_AST_BINARY;
+            }
             else if (strcmp(opt_name, "st") == 0) {
                 g_display_statistics = true; 
             }
@@ -315,6 +319,9 @@ int main(int argc, char ** argv) {
                 else if (strcmp(ext, "smt") == 0) {
                     g_input_kind = IN_SMTLIB;
                 }
+                else if (strcmp(ext, "z3b") == 0) {
+                    g_input_kind = IN_AST_BINARY;
+                }
             }
 	}
         switch (g_input_kind) {
@@ -334,6 +341,11 @@ int main(int argc, char ** argv) {
         case IN_Z3_LOG:
             replay_z3_log(g_input_file);
             break;
+        case IN_AST_BINARY:
+            if (!g_input_file)
+                error("binary AST files cannot be read from standard input.");
+            return_value = read_ast_binary(g_input_file);
+            break;
         default:
             UNREACHABLE();
         }
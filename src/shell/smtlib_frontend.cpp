@@ -31,6 +31,7 @@ Revision History:
 #include"subpaving_cmds.h"
 #include"smt_strategic_solver.h"
 #include"smt_solver.h"
+#include"ast_binary.h"
 
 extern bool g_display_statistics;
 extern void display_config();
@@ -100,12 +101,7 @@ unsigned read_smtlib_file(char const * benchmark_file) {
     return solver.get_error_code();
 }
 
-unsigned read_smtlib2_commands(char const * file_name) {
-    g_start_time = clock();
-    register_on_timeout_proc(on_timeout);
-    signal(SIGINT, on_ctrl_c);
-    cmd_context ctx;
-
+static void init_cmd_context(cmd_context & ctx) {
     ctx.set_solver_factory(mk_smt_strategic_solver_factory());
     ctx.set_interpolating_solver_factory(mk_smt_solver_factory());
 
@@ -114,6 +110,14 @@ unsigned read_smtlib2_commands(char const * file_name) {
     install_polynomial_cmds(ctx);
     install_subpaving_cmds(ctx);
     install_opt_cmds(ctx);
+}
+
+unsigned read_smtlib2_commands(char const * file_name) {
+    g_start_time = clock();
+    register_on_timeout_proc(on_timeout);
+    signal(SIGINT, on_ctrl_c);
+    cmd_context ctx;
+    init_cmd_context(ctx);
 
     g_cmd_context = &ctx;
     signal(SIGINT, on_ctrl_c);
@@ -140,3 +144,36 @@ unsigned read_smtlib2_commands(char const * file_name) {
     return result ? 0 : 1;
 }
 
+unsigned read_ast_binary(char const * file_name) {
+    g_start_time = clock();
+    register_on_timeout_proc(on_timeout);
+    signal(SIGINT, on_ctrl_c);
+    cmd_context ctx;
+    init_cmd_context(ctx);
+
+    g_cmd_context = &ctx;
+    signal(SIGINT, on_ctrl_c);
+
+    bool result = true;
+    try {
+        ast_ref_vector asts(ctx.m());
+        ast_binary_read_file(ctx.m(), file_name, asts);
+        for (unsigned i = 0; i < asts.size(); i++) {
+            if (!is_expr(asts.get(i)) || !ctx.m().is_bool(to_expr(asts.get(i))))
+                throw default_exception("binary file must contain Boolean formulas");
+            ctx.assert_expr(to_expr(asts.get(i)));
+        }
+        ctx.check_sat(0, 0);
+    }
+    catch (z3_exception & ex) {
+        std::cerr << "(error \"" << ex.msg() << "\")" << std::endl;
+        result = false;
+    }
+
+    #pragma omp critical (g_display_stats) 
+    {
+        display_statistics();
+        g_cmd_context = 0;
+    }
+    return result ? 0 : 1;
+}
@@ -21,6 +21,7 @@ Revision History:
 
 unsigned read_smtlib_file(char const * benchmark_file);
 unsigned read_smtlib2_commands(char const * command_file);
+unsigned read_ast_binary(char const * file_name);
 
 #endif /* _SMTLIB_FRONTEND_H_ */
 
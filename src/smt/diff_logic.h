@@ -127,12 +127,14 @@ class dl_graph {
         unsigned m_num_implied_literals;
         unsigned m_num_helpful_implied_literals;
         unsigned m_num_relax;
+        unsigned m_num_neg_cycles;
         void reset() {
             m_propagation_cost     = 0;
             m_implied_literal_cost = 0;
             m_num_implied_literals = 0;
             m_num_helpful_implied_literals = 0;
             m_num_relax = 0;
+            m_num_neg_cycles = 0;
         }
         stats() { reset(); }
         void collect_statistics(::statistics& st) const {
@@ -141,6 +143,7 @@ class dl_graph {
             st.update("dl impl lits",  m_num_implied_literals);
             st.update("dl impl conf lits", m_num_helpful_implied_literals);
             st.update("dl bound relax", m_num_relax);
+            st.update("dl neg cycles", m_num_neg_cycles);
         }
     };
     stats m_stats;
@@ -377,17 +380,12 @@ private:
 
         TRACE("arith", tout << id << "\n";);
 
+        // Only the nodes whose potential decreases are visited.
+        // A negative cycle exists iff the potential of root has to decrease,
+        // and it is reported as soon as root is reached.
         dl_var source = target;
-        for(;;) {
+        while (m_mark[root] == DL_UNMARKED) {
             ++m_stats.m_propagation_cost;
-            if (m_mark[root] != DL_UNMARKED) {
-                // negative cycle was found
-                SASSERT(m_gamma[root].is_neg());
-                m_heap.reset();
-                reset_marks();
-                undo_assignments();
-                return false;
-            }
             
             typename edge_id_vector::iterator it  = m_out_edges[source].begin();
             typename edge_id_vector::iterator end = m_out_edges[source].end();
@@ -424,6 +422,10 @@ private:
                 }
             }
 
+            if (m_mark[root] != DL_UNMARKED) {
+                break;
+            }
+
             if (m_heap.empty()) {
                 SASSERT(is_feasible());
                 reset_marks();
@@ -435,6 +437,13 @@ private:
             m_mark[source] = DL_PROCESSED;
             acc_assignment(source, m_gamma[source]);
         }
+        // negative cycle was found
+        SASSERT(m_gamma[root].is_neg());
+        ++m_stats.m_num_neg_cycles;
+        m_heap.reset();
+        reset_marks();
+        undo_assignments();
+        return false;
     }
 
     edge const* find_relaxed_edge(edge const* e, numeral & gamma) {
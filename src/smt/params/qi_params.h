@@ -52,6 +52,7 @@ struct qi_params {
     bool               m_mbqi_trace;
     unsigned           m_mbqi_force_template;
     const char *       m_mbqi_id;
+    unsigned           m_mbqi_max_retired_guards;
 
     qi_params(params_ref const & p = params_ref()):
         /*
@@ -99,7 +100,8 @@ struct qi_params {
         m_mbqi_max_iterations(1000),
         m_mbqi_trace(false),
 	m_mbqi_force_template(10),
-        m_mbqi_id(0)  
+        m_mbqi_id(0),
+        m_mbqi_max_retired_guards(1000)
     {
         updt_params(p);
     }
@@ -27,6 +27,8 @@ void smt_params::updt_local_params(params_ref const & _p) {
     m_relevancy_lvl = p.relevancy();
     m_ematching   = p.ematching();
     m_phase_selection = static_cast<phase_selection>(p.phase_selection());
+    m_phase_target = p.phase_target();
+    m_rephase_restarts = p.rephase_restarts();
     m_restart_strategy = static_cast<restart_strategy>(p.restart_strategy());
     m_restart_factor = p.restart_factor();
     m_case_split_strategy = static_cast<case_split_strategy>(p.case_split());
@@ -93,6 +93,8 @@ struct smt_params : public preprocessor_params,
     phase_selection  m_phase_selection;
     unsigned         m_phase_caching_on;
     unsigned         m_phase_caching_off;
+    bool             m_phase_target;      //!< prefer the phases of the longest conflict-free trail
+    unsigned         m_rephase_restarts;  //!< number of restarts between resets to the best phases (0 - never)
     bool             m_minimize_lemmas;
     unsigned         m_max_conflicts;
     bool             m_simplify_clauses;
@@ -227,6 +229,8 @@ struct smt_params : public preprocessor_params,
         m_phase_selection(PS_CACHING_CONSERVATIVE),
         m_phase_caching_on(400),
         m_phase_caching_off(100),
+        m_phase_target(false),
+        m_rephase_restarts(16),
         m_minimize_lemmas(true),
         m_max_conflicts(UINT_MAX),
         m_simplify_clauses(true),
@@ -35,6 +35,9 @@ void theory_arith_params::updt_params(params_ref const & _p) {
     m_arith_ignore_int = p.arith_ignore_int();
     m_arith_bound_prop = static_cast<bound_prop_mode>(p.arith_propagation_mode());
     m_arith_dump_lemmas = p.arith_dump_lemmas();
+    m_arith_fp_simplex = p.arith_fp_simplex();
+    m_arith_fp_simplex_threshold = p.arith_fp_simplex_threshold();
+    m_arith_auto_dl = p.arith_auto_dl();
 }
 
 
@@ -81,9 +81,14 @@ struct theory_arith_params {
 
     arith_pivot_strategy    m_arith_pivot_strategy;
 
+    // double precision simplex used to find a (candidate) feasible basis
+    bool                    m_arith_fp_simplex;
+    unsigned                m_arith_fp_simplex_threshold; //!< minimal number of variables to patch
+
     // used in diff-logic
     bool                    m_arith_add_binary_bounds;
     arith_prop_strategy     m_arith_propagation_strategy;
+    bool                    m_arith_auto_dl; //!< pick sparse or dense diff-logic solver using the density of the constraint graph
 
     // used arith_eq_adapter
     bool                    m_arith_eq_bounds;
@@ -137,8 +142,11 @@ struct theory_arith_params {
         m_arith_adaptive_gcd(false),
         m_arith_propagation_threshold(UINT_MAX),
         m_arith_pivot_strategy(ARITH_PIVOT_SMALLEST),
+        m_arith_fp_simplex(false),
+        m_arith_fp_simplex_threshold(32),
         m_arith_add_binary_bounds(false),
         m_arith_propagation_strategy(ARITH_PROP_PROPORTIONAL),
+        m_arith_auto_dl(false),
         m_arith_eq_bounds(false),
         m_arith_lazy_adapter(false),
         m_arith_fixnum(false),
@@ -23,6 +23,7 @@ void theory_array_params::updt_params(params_ref const & _p) {
     smt_params_helper p(_p);
     m_array_weak = p.array_weak();
     m_array_extensional = p.array_extensional();
+    m_array_model_based_axioms = p.array_model_based_axioms();
 }
 
 
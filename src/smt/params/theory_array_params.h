@@ -38,6 +38,7 @@ struct theory_array_params : public array_simplifier_params {
     bool            m_array_always_prop_upward;
     bool            m_array_lazy_ieq;
     unsigned        m_array_lazy_ieq_delay;
+    bool            m_array_model_based_axioms;
 
     theory_array_params():
         m_array_mode(AR_FULL),
@@ -48,7 +49,8 @@ struct theory_array_params : public array_simplifier_params {
         m_array_cg(false),
         m_array_always_prop_upward(true), // UPWARDs filter is broken... TODO: fix it
         m_array_lazy_ieq(false),
-        m_array_lazy_ieq_delay(10) {
+        m_array_lazy_ieq_delay(10),
+        m_array_model_based_axioms(false) {
     }
 
 
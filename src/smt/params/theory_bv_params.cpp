@@ -23,4 +23,7 @@ void theory_bv_params::updt_params(params_ref const & _p) {
     smt_params_helper p(_p);
     m_bv_reflect = p.bv_reflect();
     m_bv_enable_int2bv2int = p.bv_enable_int2bv(); 
+    m_bv_lazy_blast = p.bv_lazy_blast();
+    m_bv_lazy_blast_min_size = p.bv_lazy_blast_min_size();
+    m_bv_word_prop = p.bv_word_prop();
 }
@@ -33,13 +33,19 @@ struct theory_bv_params {
     bool         m_bv_cc;
     unsigned     m_bv_blast_max_size;
     bool         m_bv_enable_int2bv2int;
+    bool         m_bv_lazy_blast;          // blast wide mul/div/rem circuits only when a candidate model violates them
+    unsigned     m_bv_lazy_blast_min_size;
+    bool         m_bv_word_prop;           // word-level bound propagation for comparisons with numerals
     theory_bv_params(params_ref const & p = params_ref()):
         m_bv_mode(BS_BLASTER),
         m_bv_reflect(true),
         m_bv_lazy_le(false),
         m_bv_cc(false),
         m_bv_blast_max_size(INT_MAX),
-        m_bv_enable_int2bv2int(false) {
+        m_bv_enable_int2bv2int(false),
+        m_bv_lazy_blast(false),
+        m_bv_lazy_blast_min_size(32),
+        m_bv_word_prop(false) {
         updt_params(p);
     }
     
@@ -418,8 +418,10 @@ namespace smt {
               m_ctx.display_literals_verbose(tout, m_lemma.size(), m_lemma.c_ptr());
               tout << "\n";);
         
-        if (m_params.m_minimize_lemmas)
+        if (m_params.m_minimize_lemmas) {
             minimize_lemma();
+            minimize_lemma_binres();
+        }
         
         TRACE("conflict",
               tout << "after minimization:\n";
@@ -734,6 +736,67 @@ namespace smt {
         m_ctx.m_stats.m_num_minimized_lits += sz - j;
     }
 
+    /**
+       \brief Remove the literals of the lemma that are implied by the first UIP
+       using a single binary clause.
+
+       Let the lemma be (or ~p l_1 ... l_n), where p is the first UIP. 
+       If (or ~p ~l_i) is a binary clause, then resolving the lemma with it
+       produces the lemma without l_i. So l_i can be removed.
+       The binary clauses (or ~p q) are the literals q in the watch list of p,
+       and the clauses of size 2 watching ~p.
+
+       \warning This method assumes the literals in m_lemma[1] ... m_lemma[m_lemma.size() - 1] are marked.
+    */
+    void conflict_resolution::minimize_lemma_binres() {
+        unsigned sz = m_lemma.size();
+        if (sz <= 2 || m_manager.proofs_enabled())
+            return;
+        literal p = ~m_lemma[0];
+        SASSERT(m_ctx.get_assignment(p) == l_true);
+        unsigned num_removed = 0;
+        watch_list & w   = m_watches[p.index()];
+        literal * it2    = w.begin_literals();
+        literal * end2   = w.end_literals();
+        for (; it2 != end2; ++it2) {
+            literal q = *it2;
+            if (m_ctx.is_marked(q.var()) && m_ctx.get_assignment(q) == l_true) {
+                m_ctx.unset_mark(q.var());
+                num_removed++;
+            }
+        }
+        watch_list::clause_iterator it  = w.begin_clause();
+        watch_list::clause_iterator end = w.end_clause();
+        for (; it != end; ++it) {
+            clause * cls = *it;
+            if (cls->get_num_literals() != 2)
+                continue;
+            literal q = cls->get_literal(0) == ~p ? cls->get_literal(1) : cls->get_literal(0);
+            if (m_ctx.is_marked(q.var()) && m_ctx.get_assignment(q) == l_true) {
+                m_ctx.unset_mark(q.var());
+                num_removed++;
+            }
+        }
+        if (num_removed == 0)
+            return;
+        TRACE("conflict", tout << "binary resolution removed " << num_removed << " literals\n";);
+        unsigned j = 1;
+        for (unsigned i = 1; i < sz; i++) {
+            literal l = m_lemma[i];
+            if (l.var() == null_bool_var || m_ctx.is_marked(l.var())) {
+                if (j != i) {
+                    m_lemma[j]       = m_lemma[i];
+                    m_lemma_atoms.set(j, m_lemma_atoms.get(i));
+                }
+                j++;
+            }
+        }
+        SASSERT(sz - j == num_removed);
+        m_lemma      .shrink(j);
+        m_lemma_atoms.shrink(j);
+        m_ctx.m_stats.m_num_minimized_lits += num_removed;
+    }
+
     /**
        \brief Return the proof object associated with the equality (= n1 n2)
        if it already exists. Otherwise, return 0 and add p to the todo-list.
@@ -190,6 +190,7 @@ namespace smt {
         bool process_justification_for_minimization(justification * js);
         bool implied_by_marked(literal lit);
         void minimize_lemma();
+        void minimize_lemma_binres();
 
         void structural_minimization();
 
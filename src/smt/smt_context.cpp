@@ -68,6 +68,8 @@ namespace smt {
         m_phase_cache_on(true),
         m_phase_counter(0),
         m_phase_default(false),
+        m_target_assigned(0),
+        m_best_assigned(0),
         m_conflict(null_b_justification),
         m_not_l(null_literal),
         m_conflict_resolution(mk_conflict_resolution(m, *this, m_dyn_ack_manager, p, m_assigned_literals, m_watches)),
@@ -82,7 +84,8 @@ namespace smt {
         m_generation(0),
         m_last_search_result(l_undef),
         m_last_search_failure(UNKNOWN),
-        m_searching(false) {
+        m_searching(false),
+        m_restart_requested(false) {
 
         SASSERT(m_scope_lvl == 0);
         SASSERT(m_base_lvl == 0);
@@ -1725,7 +1728,11 @@ namespace smt {
                 case PS_CACHING:
                 case PS_CACHING_CONSERVATIVE:
                 case PS_CACHING_CONSERVATIVE2:
-                    if (m_phase_cache_on && d.m_phase_available) {
+                    if (m_fparams.m_phase_target && m_target_phase[var] != l_undef) {
+                        TRACE("phase_selection", tout << "using target phase: " << m_target_phase[var] << ", var: p" << var << "\n";);
+                        is_pos = m_target_phase[var] == l_true;
+                    }
+                    else if (m_phase_cache_on && d.m_phase_available) {
                         TRACE("phase_selection", tout << "using cached value, is_pos: " << m_bdata[var].m_phase << ", var: p" << var << "\n";);
                         is_pos = m_bdata[var].m_phase;
                     }
@@ -1785,6 +1792,48 @@ namespace smt {
         }
     }
 
+    /**
+       \brief Save the phases of the conflict-free prefix of the trail,
+       that is, the literals assigned before the current scope level, 
+       if it is longer than the current target (best) trail.
+    */
+    void context::update_target_phase() {
+        unsigned sz = m_scope_lvl == 0 ? m_assigned_literals.size() : m_scopes[m_scope_lvl - 1].m_assigned_literals_lim;
+        if (sz > m_target_assigned) {
+            for (unsigned i = 0; i < sz; i++) {
+                literal l = m_assigned_literals[i];
+                m_target_phase[l.var()] = l.sign() ? l_false : l_true;
+            }
+            m_target_assigned = sz;
+        }
+        if (sz > m_best_assigned) {
+            for (unsigned i = 0; i < sz; i++) {
+                literal l = m_assigned_literals[i];
+                m_best_phase[l.var()] = l.sign() ? l_false : l_true;
+            }
+            m_best_assigned = sz;
+            TRACE("phase_selection", tout << "new best trail: " << sz << "\n";);
+        }
+    }
+
+    /**
+       \brief Reset the cached phases to the best assignment found so far.
+    */
+    void context::rephase() {
+        IF_VERBOSE(2, verbose_stream() << "(smt.rephase :best " << m_best_assigned << ")\n";);
+        m_stats.m_num_rephases++;
+        unsigned num = get_num_bool_vars();
+        for (bool_var v = 0; v < static_cast<bool_var>(num); v++) {
+            if (m_best_phase[v] != l_undef) {
+                m_bdata[v].m_phase_available = true;
+                m_bdata[v].m_phase           = m_best_phase[v] == l_true;
+            }
+            m_target_phase[v] = m_best_phase[v];
+        }
+        m_target_assigned = 0;
+        m_best_assigned   = 0;
+    }
+
     /**
        \brief Create an internal backtracking point
     */
@@ -2804,12 +2853,13 @@ namespace smt {
         if (!m_asserted_formulas.inconsistent()) {
             unsigned sz    = m_asserted_formulas.get_num_formulas();
             unsigned qhead = m_asserted_formulas.get_qhead();
-            while (qhead < sz) {
-                expr * f   = m_asserted_formulas.get_formula(qhead);
-                proof * pr = m_asserted_formulas.get_formula_proof(qhead);
-                internalize_assertion(f, pr, 0);
-                qhead++;
+            ptr_buffer<expr>  fs;
+            ptr_buffer<proof> prs;
+            for (; qhead < sz; qhead++) {
+                fs.push_back(m_asserted_formulas.get_formula(qhead));
+                prs.push_back(m_asserted_formulas.get_formula_proof(qhead));
             }
+            internalize_assertions(fs.size(), fs.c_ptr(), prs.c_ptr());
             m_asserted_formulas.commit();
         }
         if (m_asserted_formulas.inconsistent() && !inconsistent()) {
@@ -3092,6 +3142,7 @@ namespace smt {
         m_num_conflicts_since_lemma_gc = 0;
         m_restart_threshold            = m_fparams.m_restart_initial;
         m_restart_outer_threshold      = m_fparams.m_restart_initial;
+        m_restart_requested            = false;
         m_agility                      = 0.0;
         m_luby_idx                     = 1;
         m_lemma_gc_threshold           = m_fparams.m_lemma_gc_initial;
@@ -3101,6 +3152,8 @@ namespace smt {
         m_dyn_ack_manager              .init_search_eh();
         m_final_check_idx              = 0;
         m_phase_default                = false;
+        m_target_assigned              = 0;
+        m_best_assigned                = 0;
         m_case_split_queue             ->init_search_eh();
         m_next_progress_sample         = 0;
         TRACE("literal_occ", display_literal_num_occs(tout););
@@ -3138,6 +3191,7 @@ namespace smt {
             }
         }
         m_num_conflicts_since_restart = 0;
+        m_restart_requested           = false;
     }
 
     struct context::scoped_mk_model {
@@ -3189,7 +3243,7 @@ namespace smt {
                 break;
             }
             
-            bool force_restart = false;
+            bool force_restart = m_restart_requested;
             
             if (status == l_false) {
                 break;
@@ -3229,6 +3283,11 @@ namespace smt {
                            verbose_stream() << ")" << std::endl; verbose_stream().flush(););
                 // execute the restart
                 m_stats.m_num_restarts++;
+                if (m_fparams.m_phase_target) {
+                    m_target_assigned = 0;
+                    if (m_fparams.m_rephase_restarts > 0 && m_stats.m_num_restarts % m_fparams.m_rephase_restarts == 0)
+                        rephase();
+                }
                 if (m_scope_lvl > curr_lvl) {
                     pop_scope(m_scope_lvl - curr_lvl);
                     SASSERT(at_search_level());
@@ -3299,7 +3358,7 @@ namespace smt {
                     if (resource_limits_exceeded())
                         return l_undef;
                     
-                    if (m_num_conflicts_since_restart > m_restart_threshold && m_scope_lvl - m_base_lvl > 2) {
+                    if ((m_num_conflicts_since_restart > m_restart_threshold || m_restart_requested) && m_scope_lvl - m_base_lvl > 2) {
                         TRACE("search_bug", tout << "bounded-search return undef, inconsistent: " << inconsistent() << "\n";);
                         return l_undef; // restart
                     }
@@ -3487,6 +3546,8 @@ namespace smt {
         default:
             break;
         }
+        if (m_fparams.m_phase_target)
+            update_target_phase();
         if (m_fparams.m_phase_selection == PS_CACHING_CONSERVATIVE || m_fparams.m_phase_selection == PS_CACHING_CONSERVATIVE2)
             forget_phase_of_vars_in_current_level();
         m_atom_propagation_queue.reset();
@@ -171,6 +171,10 @@ namespace smt {
         bool                        m_phase_cache_on;
         unsigned                    m_phase_counter; //!< auxiliary variable used to decide when to turn on/off phase caching
         bool                        m_phase_default; //!< default phase when using phase caching
+        svector<lbool>              m_target_phase;    //!< phases of the longest conflict-free trail since the last restart
+        unsigned                    m_target_assigned;
+        svector<lbool>              m_best_phase;      //!< phases of the longest conflict-free trail since the last rephase
+        unsigned                    m_best_assigned;
         
         // A conflict is usually a single justification. That is, a justification
         // for false. If m_not_l is not null_literal, then m_conflict is a
@@ -446,6 +450,14 @@ namespace smt {
             return m_scope_lvl == m_search_lvl;
         }
 
+        /**
+           \brief Restart at the next conflict, even if the restart threshold was not reached.
+           Used by theories that have to add structure at the search level.
+        */
+        void request_restart() {
+            m_restart_requested = true;
+        }
+
         bool tracking_assumptions() const {
             return m_search_lvl > m_base_lvl;
         }
@@ -675,7 +687,11 @@ namespace smt {
 
         bool ts_visit_children(expr * n, bool gate_ctx, svector<int> & tcolors, svector<int> & fcolors, svector<expr_bool_pair> & todo);
         
-        void top_sort_expr(expr * n, svector<expr_bool_pair> & sorted_exprs);
+        void top_sort_expr(unsigned num_exprs, expr * const * exprs, svector<expr_bool_pair> & sorted_exprs);
+
+        void internalize_deep(unsigned num_exprs, expr * const * exprs);
+
+        void internalize_assertion_core(expr * n, proof * pr);
         
         void assert_default(expr * n, proof * pr);
 
@@ -831,6 +847,7 @@ namespace smt {
         unsigned           m_num_conflicts_since_restart;
         unsigned           m_num_conflicts_since_lemma_gc;
         unsigned           m_restart_threshold;
+        bool               m_restart_requested; //!< a theory asked for a restart at the next conflict
         unsigned           m_restart_outer_threshold;
         unsigned           m_luby_idx; 
         double             m_agility;
@@ -976,6 +993,10 @@ namespace smt {
 
         void update_phase_cache_counter();
 
+        void update_target_phase();
+
+        void rephase();
+
 #define ACTIVITY_LIMIT 1e100
 #define INV_ACTIVITY_LIMIT 1e-100
 
@@ -1370,6 +1391,8 @@ namespace smt {
 
         void internalize_assertion(expr * n, proof * pr, unsigned generation);
 
+        void internalize_assertions(unsigned num_exprs, expr * const * exprs, proof * const * prs);
+
         void internalize_instance(expr * body, proof * pr, unsigned generation) {
             internalize_assertion(body, pr, generation);
 #ifndef SMTCOMP
@@ -371,6 +371,7 @@ namespace smt {
         st.update("propagations", m_stats.m_num_propagations + m_stats.m_num_bin_propagations);
         st.update("binary propagations", m_stats.m_num_bin_propagations);
         st.update("restarts", m_stats.m_num_restarts);
+        st.update("rephases", m_stats.m_num_rephases);
         st.update("final checks", m_stats.m_num_final_checks);
         st.update("added eqs", m_stats.m_num_add_eq);
         st.update("mk clause", m_stats.m_num_mk_clause);
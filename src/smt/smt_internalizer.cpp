@@ -79,10 +79,10 @@ namespace smt {
         while (!todo.empty()) {
             expr * curr = todo.back();
             todo.pop_back();
-            if (visited.is_marked(n)) {
+            if (visited.is_marked(curr)) {
                 continue;
             }
-            visited.mark(n, true);
+            visited.mark(curr, true);
             if (!is_app(curr) || to_app(curr)->get_family_id() != fid) {
                 descendants.push_back(curr);
                 continue;
@@ -152,36 +152,63 @@ namespace smt {
         return visited;
     }
 
-    void context::top_sort_expr(expr * n, svector<expr_bool_pair> & sorted_exprs) {
+    /**
+       \brief Store in sorted_exprs the subterms of the given expressions in topological order.
+       The expressions themselves are not included. The colors are shared by all expressions,
+       so a subterm is visited only once.
+    */
+    void context::top_sort_expr(unsigned num_exprs, expr * const * exprs, svector<expr_bool_pair> & sorted_exprs) {
         svector<expr_bool_pair> todo;
         svector<int>      tcolors;
         svector<int>      fcolors;
-        todo.push_back(expr_bool_pair(n, true));
-        while (!todo.empty()) {
-            expr_bool_pair & p = todo.back();
-            expr * curr        = p.first;
-            bool   gate_ctx    = p.second;
-            switch (get_color(tcolors, fcolors, curr, gate_ctx)) {
-            case White:
-                set_color(tcolors, fcolors, curr, gate_ctx, Grey);
-                ts_visit_children(curr, gate_ctx, tcolors, fcolors, todo);
-                break;
-            case Grey:
-                SASSERT(ts_visit_children(curr, gate_ctx, tcolors, fcolors, todo));
-                set_color(tcolors, fcolors, curr, gate_ctx, Black);
-                if (n != curr && !m_manager.is_not(curr))
-                    sorted_exprs.push_back(expr_bool_pair(curr, gate_ctx));
-                break;
-            case Black:
-                todo.pop_back();
-                break;
-            default:
-                UNREACHABLE();
+        for (unsigned i = 0; i < num_exprs; i++) {
+            expr * n = exprs[i];
+            todo.push_back(expr_bool_pair(n, true));
+            while (!todo.empty()) {
+                expr_bool_pair & p = todo.back();
+                expr * curr        = p.first;
+                bool   gate_ctx    = p.second;
+                switch (get_color(tcolors, fcolors, curr, gate_ctx)) {
+                case White:
+                    set_color(tcolors, fcolors, curr, gate_ctx, Grey);
+                    ts_visit_children(curr, gate_ctx, tcolors, fcolors, todo);
+                    break;
+                case Grey:
+                    SASSERT(ts_visit_children(curr, gate_ctx, tcolors, fcolors, todo));
+                    set_color(tcolors, fcolors, curr, gate_ctx, Black);
+                    if (n != curr && !m_manager.is_not(curr))
+                        sorted_exprs.push_back(expr_bool_pair(curr, gate_ctx));
+                    break;
+                case Black:
+                    todo.pop_back();
+                    break;
+                default:
+                    UNREACHABLE();
+                }
             }
         }
     }
 
 #define DEEP_EXPR_THRESHOLD 1024
+
+    /**
+       \brief Internalize the subterms of the given expressions bottom-up, 
+       using a topological sort instead of recursion to avoid stack overflows.
+    */
+    void context::internalize_deep(unsigned num_exprs, expr * const * exprs) {
+        svector<expr_bool_pair> sorted_exprs;
+        top_sort_expr(num_exprs, exprs, sorted_exprs);
+        TRACE("deep_internalize", 
+              svector<expr_bool_pair>::const_iterator it  = sorted_exprs.begin();
+              svector<expr_bool_pair>::const_iterator end = sorted_exprs.end();
+              for (; it != end; ++it) {
+                  tout << "#" << it->first->get_id() << " " << it->second << "\n";
+              });
+        svector<expr_bool_pair>::const_iterator it  = sorted_exprs.begin();
+        svector<expr_bool_pair>::const_iterator end = sorted_exprs.end();
+        for (; it != end; ++it)
+            internalize(it->first, it->second);
+    }
  
     /**
        \brief Internalize an expression asserted into the logical context using the given proof as a justification.
@@ -199,19 +226,37 @@ namespace smt {
             // if the expression is deep, then execute topological sort to avoid
             // stack overflow.
             TRACE("deep_internalize", tout << "expression is deep: #" << n->get_id() << "\n" << mk_ll_pp(n, m_manager););
-            svector<expr_bool_pair> sorted_exprs;
-            top_sort_expr(n, sorted_exprs);
-            TRACE("deep_internalize", 
-                  svector<expr_bool_pair>::const_iterator it  = sorted_exprs.begin();
-                  svector<expr_bool_pair>::const_iterator end = sorted_exprs.end();
-                  for (; it != end; ++it) {
-                      tout << "#" << it->first->get_id() << " " << it->second << "\n";
-                  });
-            svector<expr_bool_pair>::const_iterator it  = sorted_exprs.begin();
-            svector<expr_bool_pair>::const_iterator end = sorted_exprs.end();
-            for (; it != end; ++it)
-                internalize(it->first, it->second);
+            internalize_deep(1, &n);
+        }
+        internalize_assertion_core(n, pr);
+    }
+
+    /**
+       \brief Internalize the given assertions (using generation 0).
+       The subterms of all deep assertions are internalized in a single pass before the assertions
+       themselves, instead of executing one topological sort per assertion.
+    */
+    void context::internalize_assertions(unsigned num_exprs, expr * const * exprs, proof * const * prs) {
+        flet<unsigned> l(m_generation, 0);
+        ptr_buffer<expr> deep;
+        for (unsigned i = 0; i < num_exprs; i++) {
+            if (get_depth(exprs[i]) > DEEP_EXPR_THRESHOLD)
+                deep.push_back(exprs[i]);
         }
+        if (!deep.empty()) {
+            TRACE("deep_internalize", tout << "deep expressions: " << deep.size() << "\n";);
+            internalize_deep(deep.size(), deep.c_ptr());
+        }
+        for (unsigned i = 0; i < num_exprs; i++) {
+            TRACE("internalize_assertion", tout << mk_pp(exprs[i], m_manager) << "\n";); 
+            internalize_assertion_core(exprs[i], prs[i]);
+        }
+    }
+
+    /**
+       \brief Assert n, the subterms of n that are deep must have been already internalized.
+    */
+    void context::internalize_assertion_core(expr * n, proof * pr) {
         SASSERT(m_manager.is_bool(n));
         if (is_gate(m_manager, n)) {
             switch(to_app(n)->get_decl_kind()) {
@@ -833,6 +878,8 @@ namespace smt {
         set_bool_var(id, v);
         m_bdata.reserve(v+1);
         m_activity.reserve(v+1);
+        m_target_phase.reserve(v+1);
+        m_best_phase.reserve(v+1);
         m_bool_var2expr.reserve(v+1);
         m_bool_var2expr[v] = n;
         literal l(v, false);
@@ -857,6 +904,8 @@ namespace smt {
             m_activity[v]      = -((m_random() % 1000) / 1000.0); 
         else
             m_activity[v]      = 0.0;
+        m_target_phase[v]      = l_undef;
+        m_best_phase[v]        = l_undef;
         m_case_split_queue->mk_var_eh(v);
         m_b_internalized_stack.push_back(n);
         m_trail_stack.push_back(&m_mk_bool_var_trail);
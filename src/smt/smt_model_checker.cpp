@@ -40,6 +40,10 @@ namespace smt {
         m_max_cexs(1),
         m_iteration_idx(0),
         m_curr_model(0),
+        m_guard(0),
+        m_num_retired_guards(0),
+        m_aux_pinned(m),
+        m_aux_sks(m),
         m_new_instances_bindings(m) {
     }
 
@@ -48,6 +52,17 @@ namespace smt {
         m_fparams = 0;
     }
 
+    bool model_checker::instance_eq_proc::operator()(instance const * i1, instance const * i2) const {
+        if (i1->m_q != i2->m_q)
+            return false;
+        unsigned num = i1->get_num_bindings();
+        for (unsigned i = 0; i < num; i++) {
+            if (i1->get_binding(i) != i2->get_binding(i))
+                return false;
+        }
+        return true;
+    }
+
     quantifier * model_checker::get_flat_quantifier(quantifier * q) {
         return m_model_finder.get_flat_quantifier(q);
     }
@@ -95,7 +110,37 @@ namespace smt {
             expr * e = *it;
             eqs.push_back(m_manager.mk_eq(sk, e));
         }
-        m_aux_context->assert_expr(m_manager.mk_or(eqs.size(), eqs.c_ptr()));
+        assert_guarded(m_manager.mk_or(eqs.size(), eqs.c_ptr()));
+    }
+
+    /**
+       \brief Assert (or (not m_guard) c) in m_aux_context.
+    */
+    void model_checker::assert_guarded(expr * c) {
+        SASSERT(m_guard != 0);
+        expr_ref r(m_manager);
+        r = m_manager.mk_or(m_manager.mk_not(m_guard), c);
+        m_aux_context->assert_expr(r);
+    }
+
+    /**
+       \brief Store in sks the skolem constants used for the (flat) quantifier q.
+       They are created only once, and reused in every round. Thus, they are
+       internalized only once in m_aux_context.
+    */
+    void model_checker::mk_sks(quantifier * q, expr_ref_vector & sks) {
+        unsigned num_decls = q->get_num_decls();
+        unsigned idx;
+        if (!m_q2sks.find(q, idx)) {
+            idx = m_aux_sks.size();
+            for (unsigned i = 0; i < num_decls; i++) 
+                m_aux_sks.push_back(m_manager.mk_fresh_const(0, q->get_decl_sort(i)));
+            m_aux_pinned.push_back(q);
+            m_q2sks.insert(q, idx);
+        }
+        sks.reset();
+        for (unsigned i = 0; i < num_decls; i++)
+            sks.push_back(m_aux_sks.get(idx + i));
     }
 
 #define PP_DEPTH 8
@@ -109,27 +154,22 @@ namespace smt {
         expr_ref tmp(m_manager);
         m_curr_model->eval(q->get_expr(), tmp, true);
         TRACE("model_checker", tout << "q after applying interpretation:\n" << mk_ismt2_pp(tmp, m_manager) << "\n";);        
-        ptr_buffer<expr> subst_args;
         unsigned num_decls = q->get_num_decls();
-        subst_args.resize(num_decls, 0);
-        sks.resize(num_decls, 0);
+        mk_sks(q, sks);
         for (unsigned i = 0; i < num_decls; i++) {
-            sort * s  = q->get_decl_sort(num_decls - i - 1);
-            expr * sk = m_manager.mk_fresh_const(0, s);
-            sks[num_decls - i - 1]        = sk;
-            subst_args[num_decls - i - 1] = sk;
+            sort * s  = q->get_decl_sort(i);
             if (m_curr_model->is_finite(s)) {
-                restrict_to_universe(sk, m_curr_model->get_known_universe(s));
+                restrict_to_universe(sks.get(i), m_curr_model->get_known_universe(s));
             }
         }
 
         expr_ref sk_body(m_manager);
         var_subst s(m_manager);
-        s(tmp, subst_args.size(), subst_args.c_ptr(), sk_body);
+        s(tmp, sks.size(), sks.c_ptr(), sk_body);
         expr_ref r(m_manager);
         r = m_manager.mk_not(sk_body);
         TRACE("model_checker", tout << "mk_neg_q_m:\n" << mk_ismt2_pp(r, m_manager) << "\n";);
-        m_aux_context->assert_expr(r);
+        assert_guarded(r);
     }
 
     bool model_checker::add_instance(quantifier * q, model * cex, expr_ref_vector & sks, bool use_inv) {
@@ -182,12 +222,22 @@ namespace smt {
               for (unsigned i = 0; i < num_decls; i++) {
                   tout << mk_ismt2_pp(bindings[i], m_manager) << "\n";
               });
+
+        buffer<char> tmp_mem;
+        tmp_mem.resize(instance::get_obj_size(num_decls));
+        instance * tmp_inst = new (tmp_mem.c_ptr()) instance(q, bindings.c_ptr(), max_generation);
+        if (m_checked_instances.contains(tmp_inst)) {
+            TRACE("model_checker", tout << "instance was already produced in this search\n";);
+            return true;
+        }
         
         for (unsigned i = 0; i < num_decls; i++) 
             m_new_instances_bindings.push_back(bindings[i]);
         void * mem = m_new_instances_region.allocate(instance::get_obj_size(q->get_num_decls()));
         instance * new_inst = new (mem) instance(q, bindings.c_ptr(), max_generation);
         m_new_instances.push_back(new_inst);
+        mem = m_checked_instances_region.allocate(instance::get_obj_size(q->get_num_decls()));
+        m_checked_instances.insert(new (mem) instance(q, bindings.c_ptr(), max_generation));
 
         return true;
     }
@@ -211,7 +261,7 @@ namespace smt {
         expr_ref blocking_clause(m_manager);
         blocking_clause = m_manager.mk_or(diseqs.size(), diseqs.c_ptr());
         TRACE("model_checker", tout << "blocking clause:\n" << mk_ismt2_pp(blocking_clause, m_manager) << "\n";);
-        m_aux_context->assert_expr(blocking_clause);
+        assert_guarded(blocking_clause);
         return true;
     }
 
@@ -220,7 +270,10 @@ namespace smt {
     */
     bool model_checker::check(quantifier * q) {
         SASSERT(!m_aux_context->relevancy());
-        m_aux_context->push();
+        SASSERT(m_guard == 0);
+        m_guard = m_manager.mk_fresh_const("mc", m_manager.mk_bool_sort());
+        m_aux_pinned.push_back(m_guard);
+        expr * assumption = m_guard;
         
         quantifier * flat_q = get_flat_quantifier(q);
         TRACE("model_checker", tout << "model checking:\n" << mk_ismt2_pp(q->get_expr(), m_manager) << "\n" << 
@@ -234,30 +287,35 @@ namespace smt {
                   tout << mk_ismt2_pp(sk, m_manager) << " " << mk_pp(m_manager.get_sort(sk), m_manager) << "\n";
               });
         
-        lbool r = m_aux_context->check();
+        lbool r = m_aux_context->check(1, &assumption);
         TRACE("model_checker", tout << "[complete] model-checker result: " << to_sat_str(r) << "\n";);
         if (r == l_false) {
-            m_aux_context->pop(1);
+            retire_guard();
             return true; // quantifier is satisfied by m_curr_model
         }
         model_ref complete_cex;
         m_aux_context->get_model(complete_cex); 
         
         // try to find new instances using instantiation sets.
-        m_model_finder.restrict_sks_to_inst_set(m_aux_context.get(), q, sks);
+        m_model_finder.restrict_sks_to_inst_set(m_aux_context.get(), q, sks, m_guard);
         
         unsigned num_new_instances = 0;
+        unsigned num_attempts      = 0;
 
         while (true) {
-            lbool r = m_aux_context->check();
+            lbool r = m_aux_context->check(1, &assumption);
             TRACE("model_checker", tout << "[restricted] model-checker (" << (num_new_instances+1) << ") result: " << to_sat_str(r) << "\n";);
             if (r == l_false)
                 break; 
             model_ref cex;
             m_aux_context->get_model(cex);
+            unsigned old_sz = m_new_instances.size();
             if (add_instance(q, cex.get(), sks, true)) {
-                num_new_instances++;
-                if (num_new_instances < m_max_cexs) {
+                // instances that were already produced in this search do not count
+                if (m_new_instances.size() > old_sz)
+                    num_new_instances++;
+                num_attempts++;
+                if (num_new_instances < m_max_cexs && num_attempts < m_max_cexs) {
                     if (!add_blocking_clause(cex.get(), sks))
                         break; // add_blocking_clause failed... stop the search for new counter-examples...
                 }
@@ -265,7 +323,7 @@ namespace smt {
             else {
                 break;
             }
-            if (num_new_instances >= m_max_cexs)
+            if (num_new_instances >= m_max_cexs || num_attempts >= m_max_cexs)
                 break;
         }
 
@@ -275,15 +333,39 @@ namespace smt {
             add_instance(q, complete_cex.get(), sks, false);
         }
 
-        m_aux_context->pop(1);
+        retire_guard();
         return false;
     }
 
+    /**
+       \brief Retract the constraints asserted using m_guard.
+    */
+    void model_checker::retire_guard() {
+        SASSERT(m_guard != 0);
+        m_aux_context->assert_expr(m_manager.mk_not(m_guard));
+        m_guard = 0;
+        m_num_retired_guards++;
+    }
+
+    void model_checker::reset_aux_context() {
+        TRACE("model_checker", tout << "resetting auxiliary context, retired guards: " << m_num_retired_guards << "\n";);
+        m_aux_context = 0;
+        m_q2sks.reset();
+        m_aux_sks.reset();
+        m_aux_pinned.reset();
+        m_num_retired_guards = 0;
+    }
+
     void model_checker::init_aux_context() {
         if (!m_fparams) {
             m_fparams = alloc(smt_params, m_context->get_fparams());
             m_fparams->m_relevancy_lvl = 0; // no relevancy since the model checking problems are quantifier free
         }
+        if (m_aux_context && m_num_retired_guards > m_params.m_mbqi_max_retired_guards) {
+            // the retracted constraints are still internalized in m_aux_context, 
+            // start from scratch to avoid the accumulation of useless terms and clauses.
+            reset_aux_context();
+        }
         if (!m_aux_context) {
             symbol logic;
             m_aux_context = m_context->mk_fresh(&logic, m_fparams.get());
@@ -357,6 +439,8 @@ namespace smt {
     void model_checker::init_search_eh() {
         m_max_cexs = m_params.m_mbqi_max_cexs;
         m_iteration_idx = 0;
+        m_checked_instances.reset();
+        m_checked_instances_region.reset();
     }
 
     void model_checker::restart_eh() {
@@ -376,6 +460,8 @@ namespace smt {
 
     void model_checker::reset() {
         reset_new_instances();
+        m_checked_instances.reset();
+        m_checked_instances_region.reset();
     }
 
     void model_checker::assert_new_instances() {
@@ -53,7 +53,21 @@ namespace smt {
         obj_map<expr, expr *>                       m_value2expr;
         friend class instantiation_set;
 
+        // The auxiliary context is kept across rounds and check_sat calls.
+        // Constraints that depend on the current model are asserted as (or (not guard) c), 
+        // where guard is a fresh constant used as an assumption, and retracted by asserting (not guard).
+        // Skolem constants are reused for each (flat) quantifier.
+        app *                                       m_guard;
+        unsigned                                    m_num_retired_guards;
+        expr_ref_vector                             m_aux_pinned;
+        obj_map<quantifier, unsigned>               m_q2sks; // flat quantifier -> position of its skolems in m_aux_sks
+        expr_ref_vector                             m_aux_sks;
+
         void init_aux_context();
+        void reset_aux_context();
+        void retire_guard();
+        void assert_guarded(expr * c);
+        void mk_sks(quantifier * q, expr_ref_vector & sks);
         expr * get_term_from_ctx(expr * val);
         void restrict_to_universe(expr * sk, obj_hashtable<expr> const & universe);
         void assert_neg_q_m(quantifier * q, expr_ref_vector & sks);
@@ -68,11 +82,30 @@ namespace smt {
             instance(quantifier * q, expr * const * bindings, unsigned gen):m_q(q), m_generation(gen) {
                 memcpy(m_bindings, bindings, q->get_num_decls() * sizeof(expr*));
             }
+            unsigned get_num_bindings() const { return m_q->get_num_decls(); }
+            expr * get_binding(unsigned idx) const { return m_bindings[idx]; }
+        };
+
+        struct instance_khasher {
+            unsigned operator()(instance const * inst) const { return inst->m_q->hash(); }
+        };
+        struct instance_chasher {
+            unsigned operator()(instance const * inst, unsigned idx) const { return inst->get_binding(idx)->hash(); }
+        };
+        struct instance_hash_proc {
+            unsigned operator()(instance const * inst) const {
+                return get_composite_hash<instance *, instance_khasher, instance_chasher>(const_cast<instance*>(inst), inst->get_num_bindings());
+            }
         };
+        struct instance_eq_proc { bool operator()(instance const * i1, instance const * i2) const; };
+        typedef ptr_hashtable<instance, instance_hash_proc, instance_eq_proc> instance_set;
 
         region                                     m_new_instances_region;
         expr_ref_vector                            m_new_instances_bindings;
         ptr_vector<instance>                       m_new_instances;
+        // instances already produced in the current search, they are not reported again.
+        region                                     m_checked_instances_region;
+        instance_set                               m_checked_instances;
         bool add_instance(quantifier * q, model * cex, expr_ref_vector & sks, bool use_inv);
         void reset_new_instances();
         void assert_new_instances();
@@ -3478,9 +3478,12 @@ namespace smt {
     
        \remark q is the quantifier before flattening.
 
+       \remark If guard is not 0, then the constraints are asserted as (or (not guard) cnstr).
+       This allows the caller to retract them without using push/pop.
+
        Return true if something was asserted.
     */
-    bool model_finder::restrict_sks_to_inst_set(context * aux_ctx, quantifier * q, expr_ref_vector const & sks) {
+    bool model_finder::restrict_sks_to_inst_set(context * aux_ctx, quantifier * q, expr_ref_vector const & sks, expr * guard) {
         // Note: we currently add instances of q instead of flat_q.
         // If the user wants instances of flat_q, it should use PULL_NESTED_QUANTIFIERS=true. This option
         // will guarantee that q == flat_q.
@@ -3512,6 +3515,8 @@ namespace smt {
             }
             expr_ref new_cnstr(m_manager);
             new_cnstr = m_manager.mk_or(eqs.size(), eqs.c_ptr());
+            if (guard != 0)
+                new_cnstr = m_manager.mk_or(m_manager.mk_not(guard), new_cnstr);
             TRACE("model_finder", tout << "assert_restriction:\n" << mk_pp(new_cnstr, m_manager) << "\n";);
             aux_ctx->assert_expr(new_cnstr);
             asserted_something = true;
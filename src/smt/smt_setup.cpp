@@ -224,6 +224,17 @@ namespace smt {
             (st.m_num_arith_eqs + st.m_num_arith_ineqs) > st.m_num_uninterpreted_constants * 9;
     }
 
+    /**
+       \brief Return true if the graph of difference constraints is dense,
+       that is, the number of edges is a sizable fraction of the number of
+       pairs of nodes. An equality contributes two edges.
+    */
+    static bool is_dense_dl_graph(static_features const & st) {
+        uint64 n = st.m_num_uninterpreted_constants + 1;
+        uint64 e = st.m_num_diff_ineqs + 2 * static_cast<uint64>(st.m_num_diff_eqs);
+        return n < 1000 && 16 * e >= n * n;
+    }
+
     bool is_in_diff_logic(static_features const & st) {
         return 
             st.m_num_arith_eqs == st.m_num_diff_eqs && 
@@ -270,14 +281,16 @@ namespace smt {
         if (m_manager.proofs_enabled()) {
             m_context.register_plugin(alloc(smt::theory_mi_arith, m_manager, m_params));
         }
-        else if (!m_params.m_arith_auto_config_simplex && is_dense(st)) {
+        else if (!m_params.m_arith_auto_config_simplex && (m_params.m_arith_auto_dl ? is_dense_dl_graph(st) : is_dense(st))) {
+            TRACE("setup", tout << "using dense diff logic...\n";);
             if (!st.m_has_rational && !m_params.m_model && st.m_arith_k_sum < rational(INT_MAX / 8))
                 m_context.register_plugin(alloc(smt::theory_dense_smi, m_manager, m_params));
             else
                 m_context.register_plugin(alloc(smt::theory_dense_mi, m_manager, m_params));
         }
         else {
-            if (m_params.m_arith_auto_config_simplex || st.m_num_uninterpreted_constants > 4 * st.m_num_bool_constants 
+            if (m_params.m_arith_auto_config_simplex || 
+                (!m_params.m_arith_auto_dl && st.m_num_uninterpreted_constants > 4 * st.m_num_bool_constants)
                 || st.m_num_ite_terms > 0 /* theory_rdl and theory_frdl do not support ite-terms */) {
                 // if (!st.m_has_rational && !m_params.m_model && st.m_arith_k_sum < rational(INT_MAX / 8)) {
                 //   TRACE("rdl_bug", tout << "using theory_smi_arith\n";);
@@ -348,7 +361,7 @@ namespace smt {
         if (m_manager.proofs_enabled()) {
             m_context.register_plugin(alloc(smt::theory_mi_arith, m_manager, m_params));
         }
-        else if (!m_params.m_arith_auto_config_simplex && is_dense(st)) {
+        else if (!m_params.m_arith_auto_config_simplex && (m_params.m_arith_auto_dl ? is_dense_dl_graph(st) : is_dense(st))) {
             TRACE("setup", tout << "using dense diff logic...\n";);
             m_params.m_phase_selection = PS_CACHING_CONSERVATIVE;
 #if 0
@@ -361,6 +374,17 @@ namespace smt {
 #endif
 
         }
+        else if (!m_params.m_arith_auto_config_simplex && m_params.m_arith_auto_dl && 
+                 st.m_num_ite_terms == 0 /* theory_idl and theory_fidl do not support ite-terms */) {
+            TRACE("setup", tout << "using sparse diff logic...\n";);
+            m_params.m_arith_bound_prop           = BP_NONE;
+            m_params.m_arith_propagation_strategy = ARITH_PROP_AGILITY;
+            m_params.m_arith_add_binary_bounds    = true;
+            if (st.m_arith_k_sum < rational(INT_MAX / 8))
+                m_context.register_plugin(alloc(smt::theory_fidl, m_manager, m_params));
+            else
+                m_context.register_plugin(alloc(smt::theory_idl, m_manager, m_params));
+        }
         else {
             // if (st.m_arith_k_sum < rational(INT_MAX / 8)) {
             //    TRACE("setup", tout << "using small integer simplex...\n";);
@@ -48,6 +48,7 @@ namespace smt {
         unsigned m_max_min; 
         unsigned m_gb_simplify, m_gb_superpose, m_gb_compute_basis, m_gb_num_processed;
         unsigned m_nl_branching, m_nl_linear, m_nl_bounds, m_nl_cross_nested;
+        unsigned m_fp_simplex, m_fp_pivots, m_fp_failed;
 
         void reset() { memset(this, 0, sizeof(theory_arith_stats)); }
         theory_arith_stats() { reset(); }
@@ -497,6 +498,7 @@ namespace smt {
         unsigned small_lemma_size() const { return m_params.m_arith_small_lemma_size; }
         bool relax_bounds() const { return m_params.m_arith_stronger_lemmas; }
         bool skip_big_coeffs() const { return m_params.m_arith_skip_rows_with_big_coeffs; }
+        unsigned fp_simplex_threshold() const { return m_params.m_arith_fp_simplex_threshold; }
         bool dump_lemmas() const { return m_params.m_arith_dump_lemmas; }
         bool process_atoms() const;
         unsigned get_num_conflicts() const { return m_num_conflicts; }
@@ -703,6 +705,50 @@ namespace smt {
         bool make_feasible();
         void sign_row_conflict(theory_var x_i, bool is_below);
 
+        // -----------------------------------
+        //
+        // Floating point simplex filter
+        //
+        // A copy of the tableau is made feasible using
+        // double precision arithmetic.  The basis and the
+        // non-base assignment found are then installed in the
+        // exact tableau, and make_feasible confirms the result
+        // (or finds the conflict) using exact arithmetic.
+        //
+        // -----------------------------------
+        struct fp_entry {
+            theory_var m_var;
+            double     m_coeff;
+            fp_entry():m_var(null_theory_var), m_coeff(0.0) {}
+            fp_entry(theory_var v, double c):m_var(v), m_coeff(c) {}
+        };
+        typedef svector<fp_entry> fp_row;
+
+        vector<fp_row>          m_fp_rows;      // double precision copy of m_rows
+        svector<theory_var>     m_fp_base_var;  // per row, base variable in the double precision tableau
+        vector<unsigned_vector> m_fp_columns;   // per var, rows that may contain the variable (may contain stale entries)
+        svector<double>         m_fp_value;     // per var
+        svector<double>         m_fp_lower;     // per var, valid if lower(v) != 0
+        svector<double>         m_fp_upper;     // per var, valid if upper(v) != 0
+        svector<int>            m_fp_var_pos;   // temporary: position of a variable in a fp_row
+        unsigned_vector         m_fp_row_mark;  // temporary: per row, used to skip duplicates in m_fp_columns
+        unsigned                m_fp_mark;
+
+        bool use_fp_simplex() const;
+        double fp_tolerance(double bound) const;
+        bool fp_below_lower(theory_var v) const;
+        bool fp_above_upper(theory_var v) const;
+        bool fp_init();
+        void fp_reset();
+        double fp_coeff(fp_row const & r, theory_var v) const;
+        theory_var fp_select_var_to_fix() const;
+        theory_var fp_select_pivot(unsigned r_id, theory_var x_i, bool is_below, double & out_a_ij) const;
+        void fp_update_value(theory_var x_j, double delta);
+        void fp_pivot(unsigned r_id, theory_var x_j, double a_ij);
+        bool fp_make_feasible_core();
+        void fp_install_basis();
+        void fp_make_feasible();
+
         // -----------------------------------
         //
         // Assert bound
@@ -1082,6 +1128,8 @@ namespace smt {
             return inf_numeral(n, r);
         }
         static bool is_infinite(inf_numeral const& ) { return false; }
+        static double to_double(numeral const & n) { return n.get_double(); }
+        static double to_double(inf_numeral const & n) { return n.get_rational().get_double(); }
         mi_ext() : m_int_epsilon(rational(1)), m_real_epsilon(rational(0), true) {}
     };
 
@@ -1099,6 +1147,7 @@ namespace smt {
             return inf_numeral(n);
         }
         static bool is_infinite(inf_numeral const& ) { return false; }
+        static double to_double(numeral const & n) { return n.get_double(); }
 
         i_ext() : m_int_epsilon(1), m_real_epsilon(1) {}
     };
@@ -1117,6 +1166,7 @@ namespace smt {
             return inf_numeral(n);
         }
         static bool is_infinite(inf_numeral const& ) { return false; }
+        static double to_double(numeral const & n) { return static_cast<double>(n.get_int()); }
 
         si_ext(): m_int_epsilon(s_integer(1)), m_real_epsilon(s_integer(1)) {}
     };
@@ -1139,6 +1189,8 @@ namespace smt {
             return inf_numeral(n, i);
         }
         static bool is_infinite(inf_numeral const& ) { return false; }
+        static double to_double(numeral const & n) { return static_cast<double>(n.get_int()); }
+        static double to_double(inf_numeral const & n) { return static_cast<double>(n.get_rational().get_int()); }
 
         smi_ext() : m_int_epsilon(s_integer(1)), m_real_epsilon(s_integer(0), true) {}
     };
@@ -1162,6 +1214,8 @@ namespace smt {
         static bool is_infinite(inf_numeral const& n) { 
             return !n.get_infinity().is_zero(); 
         }
+        static double to_double(numeral const & n) { return n.get_double(); }
+        static double to_double(inf_numeral const & n) { return n.get_rational().get_double(); }
 
         inf_ext() : m_int_epsilon(inf_rational(rational(1))), m_real_epsilon(inf_rational(rational(0), true)) {}
     };
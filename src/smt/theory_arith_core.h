@@ -1323,6 +1323,7 @@ namespace smt {
         m_var_value_table(DEFAULT_HASHTABLE_INITIAL_CAPACITY, var_value_hash(*this), var_value_eq(*this)),
         m_liberal_final_check(true),
         m_changed_assignment(false),
+        m_fp_mark(0),
         m_assume_eq_head(0),
         m_nl_rounds(0),
         m_nl_gb_exhausted(false),
@@ -1908,6 +1909,9 @@ namespace smt {
         CASSERT("arith", wf_columns());
         CASSERT("arith", valid_row_assignment());
 
+        if (use_fp_simplex())
+            fp_make_feasible();
+
         m_left_basis.reset();
         m_blands_rule    = false;
         unsigned num_repeated = 0;
@@ -21,6 +21,7 @@ Revision History:
 
 #include"theory_arith.h"
 #include"theory_arith_core.h"
+#include"theory_arith_fp.h"
 #include"theory_arith_aux.h"
 #include"theory_arith_inv.h"
 #include"theory_arith_pp.h"
@@ -0,0 +1,405 @@
+/*++
+Copyright (c) 2006 Microsoft Corporation
+
+Module Name:
+
+    theory_arith_fp.h
+
+Abstract:
+
+    Floating point filter for the simplex procedure.
+
+    A double precision copy of the tableau is made feasible using
+    Bland's rule. The resulting basis is installed in the exact
+    tableau, and the non-base variables are moved to the bounds
+    selected by the double precision simplex.
+    The exact simplex (make_feasible) is then used to confirm
+    feasibility or to detect and explain conflicts. Thus, rounding
+    errors in the double precision simplex only affect performance.
+
+Author:
+
+
+Revision History:
+
+--*/
+#ifndef _THEORY_ARITH_FP_H_
+#define _THEORY_ARITH_FP_H_
+
+#include<math.h>
+
+#define FP_FEASIBILITY_TOLERANCE 1e-9
+#define FP_PIVOT_TOLERANCE       1e-9
+#define FP_DROP_TOLERANCE        1e-12
+
+namespace smt {
+
+    // return false if d is infinite or NaN.
+    inline bool fp_is_finite(double d) { return d - d == 0.0; }
+
+    template<typename Ext>
+    bool theory_arith<Ext>::use_fp_simplex() const {
+        if (!m_params.m_arith_fp_simplex || lazy_pivoting_lvl() > 0)
+            return false;
+        unsigned num_to_patch = static_cast<unsigned>(m_to_patch.end() - m_to_patch.begin());
+        return num_to_patch >= fp_simplex_threshold();
+    }
+
+    template<typename Ext>
+    double theory_arith<Ext>::fp_tolerance(double bound) const {
+        return FP_FEASIBILITY_TOLERANCE * (1.0 + fabs(bound));
+    }
+
+    template<typename Ext>
+    bool theory_arith<Ext>::fp_below_lower(theory_var v) const {
+        return lower(v) != 0 && m_fp_value[v] < m_fp_lower[v] - fp_tolerance(m_fp_lower[v]);
+    }
+
+    template<typename Ext>
+    bool theory_arith<Ext>::fp_above_upper(theory_var v) const {
+        return upper(v) != 0 && m_fp_value[v] > m_fp_upper[v] + fp_tolerance(m_fp_upper[v]);
+    }
+
+    /**
+       \brief Create the double precision copy of the tableau.
+       Return false if the tableau contains quasi-base variables,
+       infinite values or numbers that cannot be represented as doubles.
+    */
+    template<typename Ext>
+    bool theory_arith<Ext>::fp_init() {
+        fp_reset();
+        int num_vars = get_num_vars();
+        m_fp_value.resize(num_vars, 0.0);
+        m_fp_lower.resize(num_vars, 0.0);
+        m_fp_upper.resize(num_vars, 0.0);
+        m_fp_var_pos.resize(num_vars, -1);
+        m_fp_columns.resize(num_vars);
+        for (theory_var v = 0; v < num_vars; v++) {
+            if (is_quasi_base(v))
+                return false;
+            if (is_infinite(m_value[v]))
+                return false;
+            m_fp_value[v] = to_double(m_value[v]);
+            if (lower(v) != 0) {
+                if (is_infinite(lower_bound(v)))
+                    return false;
+                m_fp_lower[v] = to_double(lower_bound(v));
+            }
+            if (upper(v) != 0) {
+                if (is_infinite(upper_bound(v)))
+                    return false;
+                m_fp_upper[v] = to_double(upper_bound(v));
+            }
+            if (!fp_is_finite(m_fp_value[v]) || !fp_is_finite(m_fp_lower[v]) || !fp_is_finite(m_fp_upper[v]))
+                return false;
+        }
+        unsigned num_rows = m_rows.size();
+        m_fp_rows.resize(num_rows);
+        m_fp_base_var.resize(num_rows, null_theory_var);
+        m_fp_row_mark.resize(num_rows, 0);
+        for (unsigned r_id = 0; r_id < num_rows; r_id++) {
+            row const & r = m_rows[r_id];
+            theory_var s  = r.get_base_var();
+            if (s == null_theory_var)
+                continue;
+            m_fp_base_var[r_id] = s;
+            fp_row & fr   = m_fp_rows[r_id];
+            typename vector<row_entry>::const_iterator it  = r.begin_entries();
+            typename vector<row_entry>::const_iterator end = r.end_entries();
+            for (; it != end; ++it) {
+                if (!it->is_dead()) {
+                    double c = to_double(it->m_coeff);
+                    if (!fp_is_finite(c))
+                        return false;
+                    fr.push_back(fp_entry(it->m_var, c));
+                    m_fp_columns[it->m_var].push_back(r_id);
+                }
+            }
+        }
+        return true;
+    }
+
+    template<typename Ext>
+    void theory_arith<Ext>::fp_reset() {
+        m_fp_rows.reset();
+        m_fp_base_var.reset();
+        m_fp_columns.reset();
+        m_fp_value.reset();
+        m_fp_lower.reset();
+        m_fp_upper.reset();
+        m_fp_var_pos.reset();
+        m_fp_row_mark.reset();
+        m_fp_mark = 0;
+    }
+
+    /**
+       \brief Return the coefficient of v in r, or 0.0 if v does not occur in r.
+    */
+    template<typename Ext>
+    double theory_arith<Ext>::fp_coeff(fp_row const & r, theory_var v) const {
+        typename fp_row::const_iterator it  = r.begin();
+        typename fp_row::const_iterator end = r.end();
+        for (; it != end; ++it) {
+            if (it->m_var == v)
+                return it->m_coeff;
+        }
+        return 0.0;
+    }
+
+    /**
+       \brief Return the smallest base variable that violates its bounds (Bland's rule).
+    */
+    template<typename Ext>
+    theory_var theory_arith<Ext>::fp_select_var_to_fix() const {
+        theory_var result = null_theory_var;
+        typename svector<theory_var>::const_iterator it  = m_fp_base_var.begin();
+        typename svector<theory_var>::const_iterator end = m_fp_base_var.end();
+        for (; it != end; ++it) {
+            theory_var s = *it;
+            if (s != null_theory_var && (result == null_theory_var || s < result) && (fp_below_lower(s) || fp_above_upper(s)))
+                result = s;
+        }
+        return result;
+    }
+
+    /**
+       \brief Double precision version of select_blands_pivot_core.
+    */
+    template<typename Ext>
+    theory_var theory_arith<Ext>::fp_select_pivot(unsigned r_id, theory_var x_i, bool is_below, double & out_a_ij) const {
+        theory_var result = null_theory_var;
+        fp_row const & r  = m_fp_rows[r_id];
+        typename fp_row::const_iterator it  = r.begin();
+        typename fp_row::const_iterator end = r.end();
+        for (; it != end; ++it) {
+            theory_var x_j = it->m_var;
+            double a_ij    = it->m_coeff;
+            if (x_j == x_i || fabs(a_ij) < FP_PIVOT_TOLERANCE)
+                continue;
+            bool is_neg = is_below ? a_ij < 0.0 : a_ij > 0.0;
+            bool can_move;
+            if (is_neg)
+                can_move = upper(x_j) == 0 || m_fp_value[x_j] < m_fp_upper[x_j];
+            else
+                can_move = lower(x_j) == 0 || m_fp_value[x_j] > m_fp_lower[x_j];
+            if (can_move && (result == null_theory_var || x_j < result)) {
+                result   = x_j;
+                out_a_ij = a_ij;
+            }
+        }
+        return result;
+    }
+
+    /**
+       \brief m_fp_value[x_j] += delta, and update the base variables of the rows containing x_j.
+    */
+    template<typename Ext>
+    void theory_arith<Ext>::fp_update_value(theory_var x_j, double delta) {
+        m_fp_value[x_j] += delta;
+        m_fp_mark++;
+        unsigned_vector const & c = m_fp_columns[x_j];
+        unsigned_vector::const_iterator it  = c.begin();
+        unsigned_vector::const_iterator end = c.end();
+        for (; it != end; ++it) {
+            unsigned r_id = *it;
+            if (m_fp_row_mark[r_id] == m_fp_mark)
+                continue;
+            m_fp_row_mark[r_id] = m_fp_mark;
+            theory_var s = m_fp_base_var[r_id];
+            if (s == null_theory_var || s == x_j)
+                continue;
+            double a_sj = fp_coeff(m_fp_rows[r_id], x_j);
+            m_fp_value[s] -= a_sj * delta;
+        }
+    }
+
+    /**
+       \brief Make x_j the base variable of row r_id in the double precision tableau.
+    */
+    template<typename Ext>
+    void theory_arith<Ext>::fp_pivot(unsigned r_id, theory_var x_j, double a_ij) {
+        m_stats.m_fp_pivots++;
+        fp_row & r = m_fp_rows[r_id];
+        typename fp_row::iterator it  = r.begin();
+        typename fp_row::iterator end = r.end();
+        for (; it != end; ++it) {
+            if (it->m_var == x_j)
+                it->m_coeff = 1.0;
+            else
+                it->m_coeff /= a_ij;
+        }
+        m_fp_base_var[r_id] = x_j;
+
+        m_fp_mark++;
+        m_fp_row_mark[r_id] = m_fp_mark;
+        unsigned_vector & c = m_fp_columns[x_j];
+        for (unsigned i = 0; i < c.size(); i++) {
+            unsigned r2_id = c[i];
+            if (m_fp_row_mark[r2_id] == m_fp_mark)
+                continue;
+            m_fp_row_mark[r2_id] = m_fp_mark;
+            if (m_fp_base_var[r2_id] == null_theory_var)
+                continue;
+            fp_row & r2 = m_fp_rows[r2_id];
+            double a_kj = fp_coeff(r2, x_j);
+            if (a_kj == 0.0)
+                continue; // stale entry
+            // r2 <- r2 - a_kj * r
+            for (unsigned k = 0; k < r2.size(); k++)
+                m_fp_var_pos[r2[k].m_var] = k;
+            for (it = r.begin(); it != end; ++it) {
+                theory_var v = it->m_var;
+                int pos = m_fp_var_pos[v];
+                if (pos != -1) {
+                    r2[pos].m_coeff -= a_kj * it->m_coeff;
+                }
+                else {
+                    m_fp_var_pos[v] = r2.size();
+                    r2.push_back(fp_entry(v, -a_kj * it->m_coeff));
+                    m_fp_columns[v].push_back(r2_id);
+                }
+            }
+            // remove x_j and tiny coefficients.
+            unsigned j = 0;
+            for (unsigned k = 0; k < r2.size(); k++) {
+                theory_var v = r2[k].m_var;
+                m_fp_var_pos[v] = -1;
+                if (v == x_j || (v != m_fp_base_var[r2_id] && fabs(r2[k].m_coeff) < FP_DROP_TOLERANCE))
+                    continue;
+                r2[j] = r2[k];
+                j++;
+            }
+            r2.shrink(j);
+        }
+        c.reset();
+        c.push_back(r_id);
+    }
+
+    /**
+       \brief Double precision simplex using Bland's rule.
+       Return true if a feasible assignment (modulo tolerance) was found.
+    */
+    template<typename Ext>
+    bool theory_arith<Ext>::fp_make_feasible_core() {
+        unsigned max_pivots = 4 * m_fp_rows.size() + 128;
+        unsigned num_pivots = 0;
+        svector<int> var_row;
+        var_row.resize(get_num_vars(), -1);
+        for (unsigned r_id = 0; r_id < m_fp_base_var.size(); r_id++) {
+            if (m_fp_base_var[r_id] != null_theory_var)
+                var_row[m_fp_base_var[r_id]] = r_id;
+        }
+        while (num_pivots < max_pivots) {
+            theory_var x_i = fp_select_var_to_fix();
+            if (x_i == null_theory_var)
+                return true;
+            bool is_below = fp_below_lower(x_i);
+            unsigned r_id = var_row[x_i];
+            double a_ij;
+            theory_var x_j = fp_select_pivot(r_id, x_i, is_below, a_ij);
+            if (x_j == null_theory_var) {
+                // conflict (modulo rounding errors), it will be detected by the exact simplex.
+                TRACE("arith_fp", tout << "fp conflict at v" << x_i << "\n";);
+                return false;
+            }
+            double new_val = is_below ? m_fp_lower[x_i] : m_fp_upper[x_i];
+            double theta   = (m_fp_value[x_i] - new_val) / a_ij;
+            fp_update_value(x_j, theta);
+            m_fp_value[x_i] = new_val;
+            if (!fp_is_finite(m_fp_value[x_j]))
+                return false;
+            fp_pivot(r_id, x_j, a_ij);
+            var_row[x_i] = -1;
+            var_row[x_j] = r_id;
+            num_pivots++;
+        }
+        TRACE("arith_fp", tout << "fp simplex gave up after " << num_pivots << " pivots\n";);
+        return false;
+    }
+
+    /**
+       \brief Install the basis and non-base assignment found by the double precision simplex
+       in the exact tableau.
+    */
+    template<typename Ext>
+    void theory_arith<Ext>::fp_install_basis() {
+        int num_vars = get_num_vars();
+        svector<bool> fp_base;
+        fp_base.resize(num_vars, false);
+        typename svector<theory_var>::const_iterator it  = m_fp_base_var.begin();
+        typename svector<theory_var>::const_iterator end = m_fp_base_var.end();
+        for (; it != end; ++it) {
+            if (*it != null_theory_var)
+                fp_base[*it] = true;
+        }
+        // 1. make the exact basis equal to the double precision one.
+        for (it = m_fp_base_var.begin(); it != end; ++it) {
+            theory_var x_j = *it;
+            if (x_j == null_theory_var || !is_non_base(x_j))
+                continue;
+            column & c = m_columns[x_j];
+            typename svector<col_entry>::const_iterator cit  = c.begin_entries();
+            typename svector<col_entry>::const_iterator cend = c.end_entries();
+            for (; cit != cend; ++cit) {
+                if (cit->is_dead())
+                    continue;
+                row & r      = m_rows[cit->m_row_id];
+                theory_var s = r.get_base_var();
+                if (s != null_theory_var && is_base(s) && !fp_base[s]) {
+                    numeral a_ij = r[cit->m_row_idx].m_coeff;
+                    pivot<true>(s, x_j, a_ij, m_eager_gcd);
+                    break;
+                }
+            }
+        }
+        // 2. move non-base variables to the bounds selected by the double precision simplex.
+        inf_numeral delta;
+        for (theory_var v = 0; v < num_vars; v++) {
+            if (!is_non_base(v))
+                continue;
+            bound * target = 0;
+            if (below_lower(v))
+                target = lower(v);
+            else if (above_upper(v))
+                target = upper(v);
+            else if (lower(v) != 0 && fabs(m_fp_value[v] - m_fp_lower[v]) <= fp_tolerance(m_fp_lower[v]))
+                target = lower(v);
+            else if (upper(v) != 0 && fabs(m_fp_value[v] - m_fp_upper[v]) <= fp_tolerance(m_fp_upper[v]))
+                target = upper(v);
+            if (target != 0 && get_value(v) != target->get_value()) {
+                delta  = target->get_value();
+                delta -= get_value(v);
+                update_value(v, delta);
+            }
+        }
+        // 3. the base variables changed, recompute the set of variables to patch.
+        m_to_patch.reset();
+        for (theory_var v = 0; v < num_vars; v++) {
+            if (is_base(v) && (below_lower(v) || above_upper(v)))
+                m_to_patch.insert(v);
+        }
+    }
+
+    /**
+       \brief Use the double precision simplex to find a candidate
+       feasible basis for make_feasible.
+    */
+    template<typename Ext>
+    void theory_arith<Ext>::fp_make_feasible() {
+        m_stats.m_fp_simplex++;
+        TRACE("arith_fp", tout << "fp simplex, rows: " << m_rows.size() << "\n";);
+        if (fp_init() && fp_make_feasible_core()) {
+            fp_install_basis();
+            CASSERT("arith", wf_rows());
+            CASSERT("arith", wf_columns());
+            CASSERT("arith", valid_row_assignment());
+        }
+        else {
+            m_stats.m_fp_failed++;
+        }
+        fp_reset();
+    }
+
+};
+
+#endif /* _THEORY_ARITH_FP_H_ */
@@ -29,6 +29,9 @@ namespace smt {
         st.update("arith conflicts", m_stats.m_conflicts);
         st.update("add rows", m_stats.m_add_rows);
         st.update("pivots", m_stats.m_pivots);
+        st.update("fp simplex", m_stats.m_fp_simplex);
+        st.update("fp pivots", m_stats.m_fp_pivots);
+        st.update("fp simplex failed", m_stats.m_fp_failed);
         st.update("assert lower", m_stats.m_assert_lower);
         st.update("assert upper", m_stats.m_assert_upper);
         st.update("assert diseq", m_stats.m_assert_diseq);
@@ -40,6 +40,8 @@ namespace smt {
         theory_array_base::init(ctx);
         if (!ctx->relevancy())
             m_params.m_array_laziness = 0;
+        if (m_params.m_array_model_based_axioms)
+            m_params.m_array_delay_exp_axiom = true;
     }
 
     void theory_array::merge_eh(theory_var v1, theory_var v2, theory_var, theory_var) {
@@ -100,6 +102,8 @@ namespace smt {
         m_trail_stack.push(push_back_trail<theory_array, enode *, false>(d->m_parent_selects));
         ptr_vector<enode>::iterator it  = d->m_stores.begin();
         ptr_vector<enode>::iterator end = d->m_stores.end();
+        if (m_params.m_array_model_based_axioms)
+            it = end; // instantiated by assert_model_based_axioms
         for (; it != end; ++it) {
             instantiate_axiom2a(s, *it);
         }
@@ -205,6 +209,8 @@ namespace smt {
         m_trail_stack.push(push_back_trail<theory_array, enode *, false>(d->m_stores));
         ptr_vector<enode>::iterator it  = d->m_parent_selects.begin();
         ptr_vector<enode>::iterator end = d->m_parent_selects.end();
+        if (m_params.m_array_model_based_axioms)
+            it = end; // instantiated by assert_model_based_axioms
         for (; it != end; ++it) {
             SASSERT(is_select(*it));
             instantiate_axiom2a(*it, s);
@@ -324,6 +330,11 @@ namespace smt {
             SASSERT(m_var_data[v2]->m_is_array);
             TRACE("ext", tout << "extensionality:\n" << mk_bounded_pp(get_enode(v1)->get_owner(), get_manager(), 5) << "\n" << 
                   mk_bounded_pp(get_enode(v2)->get_owner(), get_manager(), 5) << "\n";);
+            if (m_params.m_array_model_based_axioms) {
+                m_lazy_diseqs.push_back(enode_pair(get_enode(v1), get_enode(v2)));
+                m_trail_stack.push(push_back_trail<theory_array, enode_pair, false>(m_lazy_diseqs));
+                return;
+            }
             instantiate_extensionality(get_enode(v1), get_enode(v2));
         }
     }
@@ -403,6 +414,8 @@ namespace smt {
     }
 
     final_check_status theory_array::assert_delayed_axioms() {
+        if (m_params.m_array_model_based_axioms)
+            return assert_model_based_axioms();
         if (!m_params.m_array_delay_exp_axiom)
             return FC_DONE;
         final_check_status r = FC_DONE;
@@ -415,6 +428,151 @@ namespace smt {
         return r;
     }
 
+    /**
+       \brief Return true if the indices of select are equal to the indices of store in the logical context.
+    */
+    bool theory_array::is_store_index(enode * store, enode * select) const {
+        unsigned num_args = select->get_num_args();
+        for (unsigned i = 1; i < num_args; i++) 
+            if (store->get_arg(i)->get_root() != select->get_arg(i)->get_root())
+                return false;
+        return true;
+    }
+
+    /**
+       \brief Check the axiom select(store(a, i, v), j) = select(a, j) or i = j 
+       for the selects over each store equivalence class. The axiom is instantiated when
+       select(a, j) is missing or it is not in the equivalence class of the select over the store.
+
+       Remark: m_selects must have been populated by collect_selects.
+    */
+    bool theory_array::check_store_axioms_downward() {
+        context & ctx     = get_context();
+        bool result       = false;
+        unsigned num_vars = get_num_vars();
+        for (theory_var v = 0; v < num_vars; v++) {
+            if (!is_root(v) || !ctx.is_relevant(get_enode(v)))
+                continue;
+            var_data * d = m_var_data[v];
+            ptr_vector<enode>::iterator it  = d->m_stores.begin();
+            ptr_vector<enode>::iterator end = d->m_stores.end();
+            for (; it != end; ++it) {
+                enode * store = *it;
+                if (!ctx.is_relevant(store))
+                    continue;
+                select_set * a_selects = 0;
+                m_selects.find(store->get_arg(0)->get_root(), a_selects);
+                ptr_vector<enode>::iterator it2  = d->m_parent_selects.begin();
+                ptr_vector<enode>::iterator end2 = d->m_parent_selects.end();
+                for (; it2 != end2; ++it2) {
+                    enode * select = *it2;
+                    if (!ctx.is_relevant(select) || is_store_index(store, select))
+                        continue;
+                    m_stats.m_num_model_checks++;
+                    enode * other = 0;
+                    if (a_selects && a_selects->find(select, other) && other->get_root() == select->get_root())
+                        continue;
+                    if (assert_store_axiom2(store, select)) {
+                        m_stats.m_num_axiom2a++;
+                        result = true;
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+       \brief Propagate the selects over an array a to the stores over a, as the model generator
+       does (see propagate_selects), and instantiate the axiom 
+       select(store(a, i, v), j) = select(a, j) or i = j 
+       when the store already has a select at j in a different equivalence class.
+
+       Remark: m_selects must have been populated by collect_selects.
+    */
+    bool theory_array::check_store_axioms_upward() {
+        context & ctx = get_context();
+        bool result   = false;
+        svector<enode_pair> todo;
+        for (unsigned i = 0; i < m_selects_domain.size(); ++i) {
+            enode * r = m_selects_domain[i];
+            select_set::iterator it  = m_selects_range[i]->begin();
+            select_set::iterator end = m_selects_range[i]->end();
+            for (; it != end; ++it)
+                todo.push_back(enode_pair(r, *it));
+        }
+        for (unsigned qhead = 0; qhead < todo.size(); qhead++) {
+            enode * r      = todo[qhead].first;
+            enode * select = todo[qhead].second;
+            if (!ctx.is_relevant(r))
+                continue;
+            enode_vector::const_iterator it  = r->begin_parents();
+            enode_vector::const_iterator end = r->end_parents();
+            for (; it != end; ++it) {
+                enode * store = *it;
+                if (!ctx.is_relevant(store) || !is_store(store) || store->get_arg(0)->get_root() != r)
+                    continue;
+                if (is_store_index(store, select))
+                    continue;
+                m_stats.m_num_model_checks++;
+                select_set * store_selects = get_select_set(store);
+                enode * other = 0;
+                if (store_selects->find(select, other)) {
+                    if (other->get_root() != select->get_root() && assert_store_axiom2(store, select)) {
+                        m_stats.m_num_axiom2b++;
+                        result = true;
+                    }
+                    continue;
+                }
+                store_selects->insert(select);
+                todo.push_back(enode_pair(store->get_root(), select));
+            }
+        }
+        return result;
+    }
+
+    /**
+       \brief Instantiate the extensionality axiom for the delayed array disequalities 
+       that are not already witnessed by disequal selects.
+    */
+    bool theory_array::check_extensionality_axioms() {
+        context & ctx = get_context();
+        bool result   = false;
+        svector<enode_pair>::iterator it  = m_lazy_diseqs.begin();
+        svector<enode_pair>::iterator end = m_lazy_diseqs.end();
+        for (; it != end; ++it) {
+            enode * n1 = it->first;
+            enode * n2 = it->second;
+            if (!ctx.is_relevant(n1) || !ctx.is_relevant(n2))
+                continue;
+            m_stats.m_num_model_checks++;
+            if (m_params.m_array_extensional && assert_extensionality(n1, n2)) {
+                m_stats.m_num_extensionality++;
+                result = true;
+            }
+        }
+        return result;
+    }
+
+    /**
+       \brief Model-based instantiation of the read-over-write and extensionality axioms.
+       The axioms are only instantiated for the pairs (store, select) and the disequalities 
+       violated by the candidate model built by the model generator. Instantiated pairs are
+       cached by the context fingerprints, so they are not checked again in the same branch.
+    */
+    final_check_status theory_array::assert_model_based_axioms() {
+        collect_selects();
+        bool r1 = check_store_axioms_downward();
+        bool r2 = check_store_axioms_upward();
+        std::for_each(m_selects_range.begin(), m_selects_range.end(), delete_proc<select_set>());
+        m_selects.reset();
+        m_selects_domain.reset();
+        m_selects_range.reset();
+        bool r3 = check_extensionality_axioms();
+        TRACE("array", tout << "model based axioms: " << r1 << " " << r2 << " " << r3 << "\n";);
+        return r1 || r2 || r3 ? FC_CONTINUE : FC_DONE;
+    }
+
     final_check_status theory_array::mk_interface_eqs_at_final_check() {
         unsigned n = mk_interface_eqs();
         m_stats.m_num_eq_splits += n;
@@ -474,6 +632,7 @@ namespace smt {
         st.update("array exp ax2", m_stats.m_num_axiom2b);
         st.update("array ext ax", m_stats.m_num_extensionality);
         st.update("array splits", m_stats.m_num_eq_splits);
+        st.update("array model checks", m_stats.m_num_model_checks);
     }
 
 };
@@ -37,6 +37,8 @@ namespace smt {
         m_bits.push_back(literal_vector());
         m_wpos.push_back(0);
         m_zero_one_bits.push_back(zero_one_bits());
+        m_word_lower.push_back(UINT_MAX);
+        m_word_upper.push_back(UINT_MAX);
         get_context().attach_th_var(n, this, r);
         return r;
     }
@@ -733,6 +735,167 @@ namespace smt {
     MK_AC_BINARY(internalize_xnor,     mk_xnor);
     MK_BINARY(internalize_comp,     mk_comp);
 
+    /**
+       \brief Internalize a wide multiplier, divider or remainder without its circuit.
+       The bits of n are fresh literals, and the circuit is asserted on demand by refine_lazy_terms.
+       Return false if n should be bit-blasted eagerly.
+    */
+    bool theory_bv::internalize_lazy(app * n) {
+        if (!m_params.m_bv_lazy_blast || get_bv_size(n) < m_params.m_bv_lazy_blast_min_size)
+            return false;
+        SASSERT(!get_context().e_internalized(n));
+        SASSERT(n->get_num_args() >= 2);
+        process_args(n);
+        enode * e = mk_enode(n);
+        mk_bits(e->get_th_var(get_id()));
+        m_lazy_terms.push_back(n);
+        m_trail_stack.push(push_back_trail<theory_bv, app*, false>(m_lazy_terms));
+        m_stats.m_num_lazy_terms++;
+        TRACE("bv_lazy", tout << "delaying circuit of #" << n->get_id() << "\n";);
+        return true;
+    }
+
+    void theory_bv::mk_lazy_op(app * n, expr_ref_vector const & arg1_bits, expr_ref_vector const & arg2_bits, expr_ref_vector & bits) {
+        SASSERT(arg1_bits.size() == arg2_bits.size());
+        unsigned sz = arg1_bits.size();
+        switch (n->get_decl_kind()) {
+        case OP_BMUL:    m_bb.mk_multiplier(sz, arg1_bits.c_ptr(), arg2_bits.c_ptr(), bits); break;
+        case OP_BUDIV_I: m_bb.mk_udiv(sz, arg1_bits.c_ptr(), arg2_bits.c_ptr(), bits); break;
+        case OP_BSDIV_I: m_bb.mk_sdiv(sz, arg1_bits.c_ptr(), arg2_bits.c_ptr(), bits); break;
+        case OP_BUREM_I: m_bb.mk_urem(sz, arg1_bits.c_ptr(), arg2_bits.c_ptr(), bits); break;
+        case OP_BSREM_I: m_bb.mk_srem(sz, arg1_bits.c_ptr(), arg2_bits.c_ptr(), bits); break;
+        case OP_BSMOD_I: m_bb.mk_smod(sz, arg1_bits.c_ptr(), arg2_bits.c_ptr(), bits); break;
+        default:
+            UNREACHABLE();
+        }
+    }
+
+    /**
+       \brief Return true if the values assigned to the arguments and the result of the lazy term n
+       agree with the semantics of its operator. The circuit is evaluated over constant bits, so
+       the check uses exactly the semantics asserted by blast_lazy_term.
+    */
+    bool theory_bv::is_lazy_consistent(app * n) {
+        ast_manager & m = get_manager();
+        enode * e       = get_context().get_enode(n);
+        unsigned sz     = get_bv_size(n);
+        numeral val;
+        expr_ref_vector bits(m), arg_bits(m), new_bits(m), expected(m);
+        unsigned i = n->get_num_args();
+        --i;
+        if (!get_fixed_value(get_arg_var(e, i), val))
+            return false;
+        m_bb.num2bits(val, sz, bits);
+        while (i > 0) {
+            --i;
+            if (!get_fixed_value(get_arg_var(e, i), val))
+                return false;
+            arg_bits.reset();
+            m_bb.num2bits(val, sz, arg_bits);
+            new_bits.reset();
+            mk_lazy_op(n, arg_bits, bits, new_bits);
+            bits.swap(new_bits);
+        }
+        if (!get_fixed_value(e->get_th_var(get_id()), val))
+            return false;
+        m_bb.num2bits(val, sz, expected);
+        for (unsigned j = 0; j < sz; ++j) {
+            if (bits.get(j) != expected.get(j))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+       \brief Assert the circuit of the lazy term n: each bit of n is equivalent to the
+       corresponding output of the circuit.
+    */
+    void theory_bv::blast_lazy_term(app * n) {
+        context & ctx   = get_context();
+        ast_manager & m = get_manager();
+        enode * e       = ctx.get_enode(n);
+        theory_var v    = e->get_th_var(get_id());
+        expr_ref_vector bits(m), arg_bits(m), new_bits(m);
+        unsigned i = n->get_num_args();
+        --i;
+        get_arg_bits(e, i, bits);
+        while (i > 0) {
+            --i;
+            arg_bits.reset();
+            get_arg_bits(e, i, arg_bits);
+            new_bits.reset();
+            mk_lazy_op(n, arg_bits, bits, new_bits);
+            bits.swap(new_bits);
+        }
+        SASSERT(bits.size() == m_bits[v].size());
+        unsigned sz = bits.size();
+        for (unsigned j = 0; j < sz; ++j) {
+            expr_ref s_bit(m);
+            simplify_bit(bits.get(j), s_bit);
+            ctx.internalize(s_bit, true);
+            literal l1 = ctx.get_literal(s_bit);
+            literal l2 = m_bits[v][j];
+            if (l1 == l2)
+                continue;
+            ctx.mark_as_relevant(l1);
+            ctx.mk_th_axiom(get_id(), ~l1, l2);
+            ctx.mk_th_axiom(get_id(), l1, ~l2);
+        }
+        m_lazy_blasted.insert(n);
+        m_trail_stack.push(insert_obj_trail<theory_bv, app>(m_lazy_blasted, n));
+        m_stats.m_num_lazy_blasts++;
+        TRACE("bv_lazy", tout << "blasted #" << n->get_id() << "\n" << mk_bounded_pp(n, m) << "\n";);
+    }
+
+    /**
+       \brief Assert the circuits of the relevant lazy terms violated by the current assignment.
+       Return true if some circuit was asserted.
+
+       The circuits asserted above the search level are removed on backtracking, so they are
+       also queued in m_lazy_pending, and a restart is requested to make them persistent.
+    */
+    bool theory_bv::refine_lazy_terms() {
+        context & ctx  = get_context();
+        bool refined   = false;
+        for (unsigned i = 0; i < m_lazy_terms.size(); ++i) {
+            app * n = m_lazy_terms[i];
+            if (m_lazy_blasted.contains(n) || !ctx.is_relevant(n))
+                continue;
+            if (!is_lazy_consistent(n)) {
+                blast_lazy_term(n);
+                if (ctx.get_scope_level() > ctx.get_search_level()) {
+                    m_lazy_pending.push_back(i);
+                    ctx.request_restart();
+                }
+                refined = true;
+            }
+        }
+        return refined;
+    }
+
+    bool theory_bv::can_propagate() {
+        context & ctx = get_context();
+        return !m_lazy_pending.empty() && ctx.get_scope_level() <= ctx.get_search_level();
+    }
+
+    /**
+       rief Re-assert, at the search level, the circuits blasted by refine_lazy_terms in deeper scopes.
+
+       Remark: m_lazy_pending stores positions instead of terms because the terms may have been
+       removed by backtracking. A stale position may blast a different lazy term, which is harmless.
+    */
+    void theory_bv::propagate() {
+        if (!can_propagate())
+            return;
+        svector<unsigned>::iterator it  = m_lazy_pending.begin();
+        svector<unsigned>::iterator end = m_lazy_pending.end();
+        for (; it != end; ++it) {
+            if (*it < m_lazy_terms.size() && !m_lazy_blasted.contains(m_lazy_terms[*it]))
+                blast_lazy_term(m_lazy_terms[*it]);
+        }
+        m_lazy_pending.reset();
+    }
+
 #define MK_PARAMETRIC_UNARY(NAME, BLAST_OP)                                     \
     void theory_bv::NAME(app * n) {                                             \
         SASSERT(!get_context().e_internalized(n));                              \
@@ -793,12 +956,12 @@ namespace smt {
         switch (term->get_decl_kind()) {
         case OP_BV_NUM:         internalize_num(term); return true;
         case OP_BADD:           internalize_add(term); return true;
-        case OP_BMUL:           internalize_mul(term); return true;
-        case OP_BSDIV_I:        internalize_sdiv(term); return true;
-        case OP_BUDIV_I:        internalize_udiv(term); return true;
-        case OP_BSREM_I:        internalize_srem(term); return true;
-        case OP_BUREM_I:        internalize_urem(term); return true;
-        case OP_BSMOD_I:        internalize_smod(term); return true;
+        case OP_BMUL:           if (!internalize_lazy(term)) internalize_mul(term); return true;
+        case OP_BSDIV_I:        if (!internalize_lazy(term)) internalize_sdiv(term); return true;
+        case OP_BUDIV_I:        if (!internalize_lazy(term)) internalize_udiv(term); return true;
+        case OP_BSREM_I:        if (!internalize_lazy(term)) internalize_srem(term); return true;
+        case OP_BUREM_I:        if (!internalize_lazy(term)) internalize_urem(term); return true;
+        case OP_BSMOD_I:        if (!internalize_lazy(term)) internalize_smod(term); return true;
         case OP_BAND:           internalize_and(term); return true;
         case OP_BOR:            internalize_or(term); return true;
         case OP_BNOT:           internalize_not(term); return true;
@@ -901,6 +1064,8 @@ namespace smt {
         le_atom * a     = new (get_region()) le_atom(l, def);
         insert_bv2a(l.var(), a);
         m_trail_stack.push(mk_atom_trail(l.var()));
+        if (!Signed && m_params.m_bv_word_prop) 
+            init_word_atom(n, a);
         if (!ctx.relevancy() || !m_params.m_bv_lazy_le) {
             ctx.mk_th_axiom(get_id(),  l, ~def);
             ctx.mk_th_axiom(get_id(), ~l,  def);
@@ -1109,9 +1274,214 @@ namespace smt {
             }
             TRACE("bv", tout << m_prop_queue.size() << "\n";);
             propagate_bits();
+            if (m_params.m_bv_word_prop) {
+                for (curr = b->m_occs; curr && !ctx.inconsistent(); curr = curr->m_next) {
+                    if (has_word_bounds(curr->m_var))
+                        check_word_bounds(curr->m_var);
+                }
+            }
+        }
+        else if (m_params.m_bv_word_prop) {
+            le_atom * le = static_cast<le_atom*>(a);
+            if (le->m_word_var != null_theory_var)
+                assert_word_bound(le, is_true);
         }
     }
-    
+
+    /**
+       \brief Record the word-level view of the unsigned comparison n if one of its arguments is a numeral.
+    */
+    void theory_bv::init_word_atom(app * n, le_atom * a) {
+        context & ctx = get_context();
+        numeral val;
+        unsigned sz;
+        if (get_bv_size(to_app(n->get_arg(0))) > 64)
+            return;
+        if (m_util.is_numeral(n->get_arg(1), val, sz) && !m_util.is_numeral(n->get_arg(0))) {
+            a->m_word_var   = get_var(ctx.get_enode(n->get_arg(0)));
+            a->m_is_upper   = true;
+            a->m_word_value = val.get_uint64();
+        }
+        else if (m_util.is_numeral(n->get_arg(0), val, sz) && !m_util.is_numeral(n->get_arg(1))) {
+            a->m_word_var   = get_var(ctx.get_enode(n->get_arg(1)));
+            a->m_is_upper   = false;
+            a->m_word_value = val.get_uint64();
+        }
+    }
+
+    static uint64 word_mask(unsigned sz) {
+        SASSERT(sz <= 64);
+        return sz == 64 ? ~static_cast<uint64>(0) : (static_cast<uint64>(1) << sz) - 1;
+    }
+
+    /**
+       \brief Store in r the smallest value of sz bits that is greater or equal to lo, 
+       and agrees with val on the bits in mask. Return false if there is no such value.
+    */
+    static bool word_min_consistent(uint64 lo, uint64 mask, uint64 val, unsigned sz, uint64 & r) {
+        SASSERT((val & ~mask) == 0);
+        uint64 diff = (lo ^ val) & mask;
+        if (diff == 0) {
+            r = lo;
+            return true;
+        }
+        // i is the most significant fixed bit that lo violates
+        unsigned i   = uint64_log2(diff);
+        uint64 bit   = static_cast<uint64>(1) << i;
+        uint64 below = bit - 1;
+        if (val & bit) {
+            r = (lo & ~(bit | below)) | bit | (val & below);
+            return true;
+        }
+        // lo must be increased at a free position above i
+        for (unsigned j = i + 1; j < sz; ++j) {
+            uint64 b = static_cast<uint64>(1) << j;
+            if ((mask & b) == 0 && (lo & b) == 0) {
+                r = (lo & ~(b | (b - 1))) | b | (val & (b - 1));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+       \brief Dual of word_min_consistent: largest value smaller or equal to hi.
+    */
+    static bool word_max_consistent(uint64 hi, uint64 mask, uint64 val, unsigned sz, uint64 & r) {
+        uint64 full = word_mask(sz);
+        if (!word_min_consistent(~hi & full, mask, ~val & mask, sz, r))
+            return false;
+        r = ~r & full;
+        return true;
+    }
+
+    void theory_bv::assert_word_bound(le_atom * a, bool is_true) {
+        theory_var v = a->m_word_var;
+        literal l    = is_true ? a->m_var : ~a->m_var;
+        uint64 val   = a->m_word_value;
+        bool is_lower;
+        bool empty   = false;
+        if (a->m_is_upper) {
+            // x <= c or x >= c + 1
+            is_lower = !is_true;
+            if (is_lower) {
+                empty = val == word_mask(get_bv_size(v));
+                val++;
+            }
+        }
+        else {
+            // x >= c or x <= c - 1
+            is_lower = is_true;
+            if (!is_lower) {
+                empty = val == 0;
+                val--;
+            }
+        }
+        if (empty) {
+            m_word_lits.reset();
+            m_word_lits.push_back(l);
+            set_word_conflict();
+            return;
+        }
+        set_word_bound(v, is_lower, val, l);
+    }
+
+    void theory_bv::set_word_bound(theory_var v, bool is_lower, uint64 val, literal l) {
+        svector<unsigned> & bounds = is_lower ? m_word_lower : m_word_upper;
+        unsigned idx               = bounds[v];
+        if (idx != UINT_MAX) {
+            uint64 old_val = m_word_bounds[idx].m_value;
+            if (is_lower ? val <= old_val : val >= old_val)
+                return;
+        }
+        TRACE("bv_word", tout << "v" << v << (is_lower ? " >= " : " <= ") << val << " " << l << "\n";);
+        m_trail_stack.push(vector_value_trail<theory_bv, unsigned, false>(bounds, v));
+        bounds[v] = m_word_bounds.size();
+        m_word_bounds.push_back(word_bound(val, l));
+        m_trail_stack.push(push_back_trail<theory_bv, word_bound, false>(m_word_bounds));
+        m_stats.m_num_word_bounds++;
+        check_word_bounds(v);
+    }
+
+    /**
+       \brief Set a conflict justified by the literals in m_word_lits.
+    */
+    void theory_bv::set_word_conflict() {
+        context & ctx = get_context();
+        region & r    = ctx.get_region();
+        TRACE("bv_word", tout << "conflict: " << m_word_lits << "\n";);
+        m_stats.m_num_word_conflicts++;
+        ctx.set_conflict(ctx.mk_justification(ext_theory_conflict_justification(get_id(), r, m_word_lits.size(), m_word_lits.c_ptr(), 0, 0)));
+    }
+
+    /**
+       \brief Narrow the bounds of v to the values that agree with the assigned bits of v,
+       and propagate the most significant bits shared by all values in the narrowed range.
+    */
+    void theory_bv::check_word_bounds(theory_var v) {
+        context & ctx               = get_context();
+        literal_vector const & bits = m_bits[v];
+        unsigned sz                 = bits.size();
+        unsigned lo_idx             = m_word_lower[v];
+        unsigned hi_idx             = m_word_upper[v];
+        uint64 lo                   = lo_idx == UINT_MAX ? 0 : m_word_bounds[lo_idx].m_value;
+        uint64 hi                   = hi_idx == UINT_MAX ? word_mask(sz) : m_word_bounds[hi_idx].m_value;
+        m_word_lits.reset();
+        if (lo_idx != UINT_MAX)
+            m_word_lits.push_back(m_word_bounds[lo_idx].m_lit);
+        if (hi_idx != UINT_MAX)
+            m_word_lits.push_back(m_word_bounds[hi_idx].m_lit);
+        if (lo > hi) {
+            set_word_conflict();
+            return;
+        }
+        uint64 mask = 0, val = 0;
+        for (unsigned i = 0; i < sz; ++i) {
+            switch (ctx.get_assignment(bits[i])) {
+            case l_true:
+                mask |= static_cast<uint64>(1) << i;
+                val  |= static_cast<uint64>(1) << i;
+                break;
+            case l_false:
+                mask |= static_cast<uint64>(1) << i;
+                break;
+            default:
+                break;
+            }
+        }
+        uint64 new_lo, new_hi;
+        bool ok = word_min_consistent(lo, mask, val, sz, new_lo) && word_max_consistent(hi, mask, val, sz, new_hi) && new_lo <= new_hi;
+        if (!ok || new_lo != lo || new_hi != hi) {
+            // the assigned bits were used to narrow the range
+            for (unsigned i = 0; i < sz; ++i) {
+                lbool a = ctx.get_assignment(bits[i]);
+                if (a != l_undef && bits[i] != true_literal && bits[i] != false_literal)
+                    m_word_lits.push_back(a == l_true ? bits[i] : ~bits[i]);
+            }
+        }
+        if (!ok) {
+            set_word_conflict();
+            return;
+        }
+        region & r = ctx.get_region();
+        unsigned i = sz;
+        while (i > 0) {
+            --i;
+            uint64 bit  = static_cast<uint64>(1) << i;
+            bool lo_bit = (new_lo & bit) != 0;
+            if (lo_bit != ((new_hi & bit) != 0))
+                break;
+            if (mask & bit)
+                continue;
+            literal consequent = lo_bit ? bits[i] : ~bits[i];
+            TRACE("bv_word", tout << "v" << v << " bit " << i << " := " << lo_bit << "\n";);
+            m_stats.m_num_word_props++;
+            ctx.assign(consequent, ctx.mk_justification(ext_theory_propagation_justification(get_id(), r, m_word_lits.size(), m_word_lits.c_ptr(), 0, 0, consequent)));
+            if (ctx.inconsistent())
+                return;
+        }
+    }
+
     void theory_bv::propagate_bits() {
         context & ctx = get_context();
         for (unsigned i = 0; i < m_prop_queue.size(); i++) {
@@ -1243,11 +1613,16 @@ namespace smt {
         m_bits.shrink(num_old_vars);
         m_wpos.shrink(num_old_vars);
         m_zero_one_bits.shrink(num_old_vars);
+        m_word_lower.shrink(num_old_vars);
+        m_word_upper.shrink(num_old_vars);
         theory::pop_scope_eh(num_scopes);
     }
 
     final_check_status theory_bv::final_check_eh() {
         SASSERT(check_invariant());
+        if (refine_lazy_terms()) {
+            return FC_CONTINUE;
+        }
         if (m_approximates_large_bvs) {
             return FC_GIVEUP;
         }
@@ -1258,6 +1633,10 @@ namespace smt {
         pop_scope_eh(m_trail_stack.get_num_scopes());
         m_bool_var2atom.reset();
         m_fixed_var_table.reset();
+        m_lazy_terms.reset();
+        m_lazy_blasted.reset();
+        m_lazy_pending.reset();
+        m_word_bounds.reset();
         theory::reset_eh();
     }
 
@@ -1557,6 +1936,11 @@ namespace smt {
         st.update("bv dynamic diseqs", m_stats.m_num_diseq_dynamic);
         st.update("bv bit2core", m_stats.m_num_bit2core);
         st.update("bv->core eq", m_stats.m_num_th2core_eq);
+        st.update("bv lazy terms", m_stats.m_num_lazy_terms);
+        st.update("bv lazy blasts", m_stats.m_num_lazy_blasts);
+        st.update("bv word bounds", m_stats.m_num_word_bounds);
+        st.update("bv word propagations", m_stats.m_num_word_props);
+        st.update("bv word conflicts", m_stats.m_num_word_conflicts);
     }
 
 #ifdef Z3DEBUG
@@ -34,6 +34,8 @@ namespace smt {
     
     struct theory_bv_stats {
         unsigned   m_num_diseq_static, m_num_diseq_dynamic, m_num_bit2core, m_num_th2core_eq, m_num_conflicts;
+        unsigned   m_num_lazy_terms, m_num_lazy_blasts;
+        unsigned   m_num_word_bounds, m_num_word_props, m_num_word_conflicts;
         void reset() { memset(this, 0, sizeof(theory_bv_stats)); }
         theory_bv_stats() { reset(); }
     };
@@ -67,7 +69,12 @@ namespace smt {
         struct le_atom : public atom {
             literal    m_var;
             literal    m_def;
-            le_atom(literal v, literal d):m_var(v), m_def(d) {}
+            // word-level view of unsigned comparisons with a numeral:
+            // (bvule x c) when m_is_upper, and (bvule c x) otherwise.
+            theory_var m_word_var;
+            bool       m_is_upper;
+            uint64     m_word_value;
+            le_atom(literal v, literal d):m_var(v), m_def(d), m_word_var(null_theory_var), m_is_upper(false), m_word_value(0) {}
             virtual ~le_atom() {}
             virtual bool is_bit() const { return false; }
         };
@@ -130,6 +137,55 @@ namespace smt {
         svector<var_pos>         m_prop_queue;
         bool                     m_approximates_large_bvs;
 
+        // -----------------------------------
+        //
+        // Lazy bit-blasting
+        //
+        // Wide multipliers, dividers and remainders are
+        // initially treated as uninterpreted: their bits are fresh
+        // literals. The circuit is only asserted in final_check_eh
+        // when the candidate assignment violates the operator, and
+        // it is asserted again at the search level (after a restart),
+        // so the refinement is not lost on backtracking.
+        //
+        // -----------------------------------
+        ptr_vector<app>          m_lazy_terms;    // terms whose circuit is (still) delayed
+        obj_hashtable<app>       m_lazy_blasted;  // lazy terms whose circuit was asserted in the current branch
+        svector<unsigned>        m_lazy_pending;  // positions in m_lazy_terms to be blasted at the search level
+
+        bool internalize_lazy(app * n);
+        void mk_lazy_op(app * n, expr_ref_vector const & arg1_bits, expr_ref_vector const & arg2_bits, expr_ref_vector & bits);
+        bool is_lazy_consistent(app * n);
+        void blast_lazy_term(app * n);
+        bool refine_lazy_terms();
+
+        // -----------------------------------
+        //
+        // Word-level bounds
+        //
+        // Unsigned bounds asserted by comparisons with numerals
+        // are kept per variable (up to 64 bits). The range is narrowed
+        // to the values that agree with the assigned bits, and the bits
+        // shared by all values in the narrowed range are propagated.
+        //
+        // -----------------------------------
+        struct word_bound {
+            uint64    m_value;
+            literal   m_lit;      // literal justifying the bound
+            word_bound(uint64 v = 0, literal l = null_literal):m_value(v), m_lit(l) {}
+        };
+        svector<word_bound>      m_word_bounds;   // bounds in the order they were asserted
+        svector<unsigned>        m_word_lower;    // per var, position of the lower bound in m_word_bounds, or UINT_MAX
+        svector<unsigned>        m_word_upper;    // per var, position of the upper bound in m_word_bounds, or UINT_MAX
+        literal_vector           m_word_lits;
+
+        void init_word_atom(app * n, le_atom * a);
+        bool has_word_bounds(theory_var v) const { return m_word_lower[v] != UINT_MAX || m_word_upper[v] != UINT_MAX; }
+        void assert_word_bound(le_atom * a, bool is_true);
+        void set_word_bound(theory_var v, bool is_lower, uint64 val, literal l);
+        void set_word_conflict();
+        void check_word_bounds(theory_var v);
+
         theory_var find(theory_var v) const { return m_find.find(v); }
         theory_var next(theory_var v) const { return m_find.next(v); }
         bool is_root(theory_var v) const { return m_find.is_root(v); }
@@ -235,6 +291,8 @@ namespace smt {
         virtual void push_scope_eh();
         virtual void pop_scope_eh(unsigned num_scopes);
         virtual final_check_status final_check_eh();
+        virtual bool can_propagate();
+        virtual void propagate();
         virtual void reset_eh();
         svector<theory_var>   m_merge_aux[2]; //!< auxiliary vector used in merge_zero_one_bits
         bool merge_zero_one_bits(theory_var r1, theory_var r2);
@@ -342,14 +342,13 @@ namespace smt {
     final_check_status theory_datatype::final_check_eh() {
         int num_vars = get_num_vars();
         final_check_status r = FC_DONE;
+        if (occurs_check()) {
+            // conflict was detected... 
+            // return...
+            return FC_CONTINUE;
+        }
         for (int v = 0; v < num_vars; v++) {
             if (v == static_cast<int>(m_find.find(v))) {
-                enode * node = get_enode(v);
-                if (occurs_check(node)) {
-                    // conflict was detected... 
-                    // return...
-                    return FC_CONTINUE;
-                }
                 if (m_params.m_dt_lazy_splits > 0) {
                     // using lazy case splits...
                     var_data * d = m_var_data[v];
@@ -364,19 +363,37 @@ namespace smt {
     }
 
     /**
-       \brief Check if n can be reached starting from n and following equalities and constructors.
-       For example, occur_check(a1) returns true in the following set of equalities:
+       \brief Check whether the graph formed by the equivalence classes and the constructors is acyclic.
+       For example, occurs_check() returns true in the following set of equalities:
        a1 = cons(v1, a2)
        a2 = cons(v2, a3)
        a3 = cons(v3, a1)
+
+       A cycle created since the last successful check must contain a class merged since then.
+       So, only the classes in m_oc_todo are used as starting points, and each class is visited at most once.
+       Remark: backtracking only removes edges, then the acyclicity of the remaining graph is preserved.
     */
-    bool theory_datatype::occurs_check(enode * n) {
-        TRACE("datatype", tout << "occurs check: #" << n->get_owner_id() << "\n";);
+    bool theory_datatype::occurs_check() {
+        TRACE("datatype", tout << "occurs check: " << m_oc_todo.size() << " merged classes\n";);
         m_to_unmark.reset();
         m_used_eqs.reset();
-        m_main   = n;
-        bool res = occurs_check_core(m_main);
+        bool res          = false;
+        unsigned num_vars = get_num_vars();
+        svector<theory_var>::const_iterator it  = m_oc_todo.begin();
+        svector<theory_var>::const_iterator end = m_oc_todo.end();
+        for (; it != end && !res; ++it) {
+            theory_var v = *it;
+            // the variable may have been deleted by backtracking.
+            if (static_cast<unsigned>(v) < num_vars)
+                res = occurs_check_core(get_enode(v));
+        }
         unmark_enodes(m_to_unmark.size(), m_to_unmark.c_ptr());
+        // when a cycle is found, the classes on the DFS stack are still marked2.
+        svector<oc_frame>::const_iterator it2  = m_oc_stack.begin();
+        svector<oc_frame>::const_iterator end2 = m_oc_stack.end();
+        for (; it2 != end2; ++it2)
+            it2->m_entry->get_root()->unset_mark2();
+        m_oc_stack.reset();
         if (res) {
             context & ctx = get_context();
             region & r    = ctx.get_region();
@@ -391,53 +408,84 @@ namespace smt {
                       tout << mk_bounded_pp(p.first->get_owner(), get_manager()) << " " << mk_bounded_pp(p.second->get_owner(), get_manager()) << "\n";
                   });
         }
+        else {
+            m_oc_todo.reset();
+        }
         return res;
     }
 
     /**
-       \brief Auxiliary method for occurs_check.
-       TODO: improve performance.
+       \brief Start visiting the equivalence class of n.
+       The root of a visited class is marked, and it is also marked2 while the class is on the DFS stack.
     */
-    bool theory_datatype::occurs_check_core(enode * app) {
-        if (app->is_marked())
-            return false;
-        
+    void theory_datatype::oc_push(enode * n) {
+        enode * r = n->get_root();
         m_stats.m_occurs_check++;
-        app->set_mark();
-        m_to_unmark.push_back(app);
-        
-        TRACE("datatype", tout << "occurs check_core: #" << app->get_owner_id() << " #" << m_main->get_owner_id() << "\n";);
-
-        theory_var v = app->get_root()->get_th_var(get_id());
-        if (v != null_theory_var) {
-            v = m_find.find(v);
-            var_data * d = m_var_data[v];
-            if (d->m_constructor) {
-                if (app != d->m_constructor)
-                    m_used_eqs.push_back(enode_pair(app, d->m_constructor));
-                unsigned num_args = d->m_constructor->get_num_args();
-                for (unsigned i = 0; i < num_args; i++) {
-                    enode * arg = d->m_constructor->get_arg(i);
-                    if (arg->get_root() == m_main->get_root()) {
-                        if (arg != m_main)
-                            m_used_eqs.push_back(enode_pair(arg, m_main));
-                        return true;
-                    }
-                    if (m_util.is_datatype(get_manager().get_sort(arg->get_owner())) && occurs_check_core(arg))
-                        return true;
-                }
-                if (app != d->m_constructor) {
-                    SASSERT(m_used_eqs.back().first  == app);
-                    SASSERT(m_used_eqs.back().second == d->m_constructor);
-                    m_used_eqs.pop_back();
-                }
+        r->set_mark();
+        r->set_mark2();
+        m_to_unmark.push_back(r);
+        enode * cnstr = 0;
+        theory_var v  = r->get_th_var(get_id());
+        if (v != null_theory_var)
+            cnstr = m_var_data[m_find.find(v)]->m_constructor;
+        m_oc_stack.push_back(oc_frame(n, cnstr));
+    }
+
+    /**
+       \brief Store in m_used_eqs the equalities justifying the cycle formed by the frames
+       m_oc_stack[idx], ..., m_oc_stack.back(), where arg is the argument of the last constructor 
+       that is in the class of m_oc_stack[idx]. The remaining edges of the cycle are 
+       constructor arguments, so they do not need a justification.
+    */
+    void theory_datatype::oc_explain(unsigned idx, enode * arg) {
+        oc_frame const & first = m_oc_stack[idx];
+        if (arg != first.m_cnstr)
+            m_used_eqs.push_back(enode_pair(arg, first.m_cnstr));
+        for (unsigned i = idx + 1; i < m_oc_stack.size(); i++) {
+            oc_frame const & f = m_oc_stack[i];
+            if (f.m_entry != f.m_cnstr)
+                m_used_eqs.push_back(enode_pair(f.m_entry, f.m_cnstr));
+        }
+    }
+
+    /**
+       \brief Auxiliary method for occurs_check. Non-recursive DFS starting at the class of n.
+    */
+    bool theory_datatype::occurs_check_core(enode * n) {
+        if (n->get_root()->is_marked())
+            return false;
+        TRACE("datatype", tout << "occurs check_core: #" << n->get_owner_id() << "\n";);
+        oc_push(n);
+        while (!m_oc_stack.empty()) {
+            oc_frame & f = m_oc_stack.back();
+            if (f.m_cnstr == 0 || f.m_idx == f.m_cnstr->get_num_args()) {
+                f.m_entry->get_root()->unset_mark2();
+                m_oc_stack.pop_back();
+                continue;
+            }
+            enode * arg = f.m_cnstr->get_arg(f.m_idx);
+            f.m_idx++;
+            if (!m_util.is_datatype(get_manager().get_sort(arg->get_owner())))
+                continue;
+            enode * r = arg->get_root();
+            if (r->is_marked2()) {
+                unsigned idx = m_oc_stack.size();
+                do {
+                    --idx;
+                } 
+                while (m_oc_stack[idx].m_entry->get_root() != r);
+                oc_explain(idx, arg);
+                return true;
             }
+            if (!r->is_marked())
+                oc_push(arg);
         }
         return false;
     }
         
     void theory_datatype::reset_eh() {
         m_trail_stack.reset();
+        m_oc_todo.reset();
         std::for_each(m_var_data.begin(), m_var_data.end(), delete_proc<var_data>());
         m_var_data.reset();
         theory::reset_eh();
@@ -531,6 +579,7 @@ namespace smt {
         SASSERT(v1 == static_cast<int>(m_find.find(v1)));
         var_data * d1 = m_var_data[v1];
         var_data * d2 = m_var_data[v2];
+        m_oc_todo.push_back(v1);
         if (d2->m_constructor != 0) {
             context & ctx = get_context();
             if (d1->m_constructor != 0 && d1->m_constructor->get_decl() != d2->m_constructor->get_decl()) {
@@ -70,11 +70,21 @@ namespace smt {
         void propagate_recognizer(theory_var v, enode * r);
         void sign_recognizer_conflict(enode * c, enode * r);
 
+        struct oc_frame {
+            enode *  m_entry;  //!< node used to enter the equivalence class.
+            enode *  m_cnstr;  //!< constructor of the equivalence class, 0 if there is none.
+            unsigned m_idx;    //!< next argument of m_cnstr to be visited.
+            oc_frame(enode * entry, enode * cnstr):m_entry(entry), m_cnstr(cnstr), m_idx(0) {}
+        };
+
         ptr_vector<enode>    m_to_unmark;
         svector<enode_pair>  m_used_eqs;
-        enode *              m_main;
-        bool occurs_check(enode * n);
+        svector<oc_frame>    m_oc_stack;
+        svector<theory_var>  m_oc_todo; //!< equivalence classes merged since the last successful occurs check.
+        bool occurs_check();
         bool occurs_check_core(enode * n);
+        void oc_push(enode * n);
+        void oc_explain(unsigned idx, enode * arg);
 
         void mk_split(theory_var v);
 
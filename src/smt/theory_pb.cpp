@@ -232,12 +232,14 @@ namespace smt {
         theory(m.mk_family_id("pb")),
         m_params(p),
         m_util(m),
-        m_max_compiled_coeff(rational(8))
+        m_max_compiled_coeff(rational(8)),
+        m_max_lemma_coeff(rational(1 << 16))
     {        
         m_learn_complements  = p.m_pb_learn_complements;
         m_conflict_frequency = p.m_pb_conflict_frequency;
         m_enable_compilation = p.m_pb_enable_compilation;
         m_enable_simplex     = p.m_pb_enable_simplex;
+        m_cutting_planes     = p.m_pb_cutting_planes;
     }
 
     theory_pb::~theory_pb() {
@@ -722,6 +724,8 @@ namespace smt {
         st.update("pb compilations", m_stats.m_num_compiles);
         st.update("pb compiled clauses", m_stats.m_num_compiled_clauses);
         st.update("pb compiled vars", m_stats.m_num_compiled_vars);
+        st.update("pb cuts", m_stats.m_num_cuts);
+        st.update("pb cut divisions", m_stats.m_num_divisions);
         m_simplex.collect_statistics(st);
     }
     
@@ -785,8 +789,14 @@ namespace smt {
             }
         }
         if (m_vwatch.find(v, ineqs)) {
+            context& ctx = get_context();
             for (unsigned i = 0; i < ineqs->size(); ++i) {
                 ineq* c = (*ineqs)[i]; 
+                // an assigned >= is propagated using the literal watches.
+                // The bounds are restored before its literal gets unassigned.
+                if (c->is_ge() && ctx.get_assignment(c->lit()) != l_undef) {
+                    continue;
+                }
                 assign_watch(v, is_true, *c);
             }
         }
@@ -871,18 +881,6 @@ namespace smt {
         return lits;
     }
 
-    class theory_pb::rewatch_vars : public trail<context> {
-        theory_pb& pb;
-        ineq&      c;
-    public:
-        rewatch_vars(theory_pb& p, ineq& c): pb(p), c(c) {}        
-        virtual void undo(context& ctx) {
-            for (unsigned i = 0; i < c.size(); ++i) {
-                pb.watch_var(c.lit(i).var(), &c);
-            }
-        }
-    };
-
     class theory_pb::negate_ineq : public trail<context> {
         ineq& c;
     public:
@@ -900,13 +898,8 @@ namespace smt {
      */
     void theory_pb::assign_ineq(ineq& c, bool is_true) {
         context& ctx = get_context();
-        ctx.push_trail(value_trail<context, scoped_mpz>(c.m_max_sum));
-        ctx.push_trail(value_trail<context, scoped_mpz>(c.m_min_sum));
-        ctx.push_trail(value_trail<context, unsigned>(c.m_nfixed));
-        ctx.push_trail(rewatch_vars(*this, c));
-
-        clear_watch(c);
         SASSERT(c.is_ge());
+        SASSERT(c.watch_size() == 0);
         unsigned sz = c.size();
         if (c.lit().sign() == is_true) {
             c.negate();
@@ -1115,11 +1108,13 @@ namespace smt {
                 //                x1 or ~L or x4
                 //
 
+                // all literals that are not false are watched at this point,
+                // so only the watched prefix needs to be visited.
                 literal_vector& lits = get_unhelpful_literals(c, true);
                 lits.push_back(c.lit());
                 scoped_mpz deficit(m_mpz_mgr);
                 deficit = c.watch_sum() - k;
-                for (unsigned i = 0; i < c.size(); ++i) {
+                for (unsigned i = 0; i < c.watch_size(); ++i) {
                     if (ctx.get_assignment(c.lit(i)) == l_undef && deficit < c.ncoeff(i)) {
                         DEBUG_CODE(validate_assign(c, lits, c.lit(i)););
                         add_assign(c, lits, c.lit(i));                  
@@ -1427,7 +1422,7 @@ namespace smt {
 
         justification* js = 0;
 
-        if (m_conflict_frequency == 0 || (m_conflict_frequency -1 == (c.m_num_propagations % m_conflict_frequency))) {
+        if (m_cutting_planes || m_conflict_frequency == 0 || (m_conflict_frequency -1 == (c.m_num_propagations % m_conflict_frequency))) {
             resolve_conflict(c);
         }
 
@@ -1596,6 +1591,9 @@ namespace smt {
                 TRACE("pb", tout << "lemma already evaluated\n";);
                 return false;
             }
+            if (m_cutting_planes) {
+                divide_lemma();
+            }
             TRACE("pb", display(tout, m_lemma););
             SASSERT(m_lemma.well_formed());         
 
@@ -1740,6 +1738,7 @@ namespace smt {
             ctx.mk_clause(m_ineq_literals.size(), m_ineq_literals.c_ptr(), 0, CLS_AUX_LEMMA, 0);
             break;
         default: {
+            ++m_stats.m_num_cuts;
             app_ref tmp = m_lemma.to_expr(false, ctx, get_manager());
             internalize_atom(tmp, false);
             ctx.mark_as_relevant(tmp.get());
@@ -1767,6 +1766,30 @@ namespace smt {
         }
     }
 
+    /**
+       \brief Divide the lemma by d and round up the coefficients and the bound
+       when its coefficients exceed m_max_lemma_coeff.
+       The lemma only contains false literals, so it remains a conflict.
+     */
+    void theory_pb::divide_lemma() {
+        numeral max_coeff(0);
+        for (unsigned i = 0; i < m_lemma.size(); ++i) {
+            if (m_lemma.coeff(i) > max_coeff) {
+                max_coeff = m_lemma.coeff(i);
+            }
+        }
+        if (max_coeff <= m_max_lemma_coeff) {
+            return;
+        }
+        numeral d = ceil(max_coeff / m_max_lemma_coeff);
+        for (unsigned i = 0; i < m_lemma.size(); ++i) {
+            m_lemma[i].second = ceil(m_lemma.coeff(i) / d);
+        }
+        m_lemma.m_k = ceil(m_lemma.k() / d);
+        ++m_stats.m_num_divisions;
+        TRACE("pb", display(tout << "divide by " << d << ": ", m_lemma););
+    }
+
     void theory_pb::remove_from_lemma(unsigned idx) {
         // Remove conseq from lemma:
         literal lit = m_lemma.lit(idx);
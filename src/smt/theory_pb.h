@@ -33,7 +33,6 @@ namespace smt {
         class  pb_justification;
         class  pb_model_value_proc;
         class  unwatch_ge;
-        class  rewatch_vars;
         class  negate_ineq;
         class  remove_var;
         class  undo_bound;
@@ -99,6 +98,8 @@ namespace smt {
             unsigned m_num_compiles;
             unsigned m_num_compiled_vars;
             unsigned m_num_compiled_clauses;
+            unsigned m_num_cuts;
+            unsigned m_num_divisions;
             void reset() { memset(this, 0, sizeof(*this)); }
             stats() { reset(); }
         };
@@ -215,7 +216,9 @@ namespace smt {
         bool                     m_learn_complements;
         bool                     m_enable_compilation;
         bool                     m_enable_simplex;
+        bool                     m_cutting_planes;
         rational                 m_max_compiled_coeff;
+        rational                 m_max_lemma_coeff;
 
         // internalize_atom:
         literal compile_arg(expr* arg);
@@ -281,6 +284,7 @@ namespace smt {
         void process_antecedent(literal l, numeral coeff);
         void process_ineq(ineq& c, literal conseq, numeral coeff);
         void remove_from_lemma(unsigned idx);
+        void divide_lemma();
         bool is_proof_justification(justification const& j) const;
 
         void hoist_maximal_values();
@@ -62,7 +62,7 @@ struct ctx_simplify_tactic::imp {
     imp(ast_manager & _m, params_ref const & p):
         m(_m),
         m_allocator("context-simplifier"),
-        m_occs(true, true),
+        m_occs(m, true, true),
         m_mk_app(m, p) {
         m_cancel = false;
         m_scope_lvl = 0;
@@ -0,0 +1,547 @@
+/*++
+Copyright (c) 2014 Microsoft Corporation
+
+Module Name:
+
+    fpa_approx_tactic.cpp
+
+Abstract:
+
+    Tactic that solves floating-point goals using reduced-precision
+    approximations.
+
+    Every floating-point term of the goal is assigned a precision level.
+    At level l, a term of sort (_ FloatingPoint e s) is computed with
+    min(e, min_ebits*2^l) exponent bits and min(s, min_sbits*2^l)
+    significand bits. Arguments are converted (to_fp) to the precision
+    of the operation using them. Predicates and equalities compare their
+    arguments in a common precision, so they are exact.
+
+    The approximated goal is solved using the QF_FPA tactic.
+    If it is satisfiable, the candidate model is lifted to full precision,
+    and every approximated operation is recomputed at full precision
+    (using mpf_manager) on the lifted values of its arguments. Only the
+    operations whose value differs are widened. When all operations agree,
+    the lifted model is a model of the original goal.
+    If the approximated goal is unsatisfiable, all terms are widened.
+    When all terms reach full precision, the original goal is solved.
+
+Author:
+
+
+Notes:
+
+--*/
+#include"tactical.h"
+#include"float_decl_plugin.h"
+#include"model.h"
+#include"ast_pp.h"
+#include"cooperate.h"
+#include"qffpa_tactic.h"
+#include"fpa_approx_tactic.h"
+
+class fpa_approx_tactic : public tactic {
+    struct imp {
+        ast_manager &           m;
+        float_util              m_util;
+        params_ref              m_params;
+        tactic_ref              m_solver;
+        unsigned                m_min_ebits;
+        unsigned                m_min_sbits;
+
+        ptr_vector<app>         m_subterms;   // subterms of the goal in post-order.
+        obj_map<app, unsigned>  m_levels;     // precision level of floating-point terms.
+        obj_map<expr, expr*>    m_approx;     // subterm -> approximation used in the current round.
+        expr_ref_vector         m_pinned;
+        obj_map<app, app*>      m_const2approx;
+
+        unsigned                m_num_rounds;
+        unsigned                m_num_refined;
+        volatile bool           m_cancel;
+
+        imp(ast_manager & _m, params_ref const & p):
+            m(_m),
+            m_util(m),
+            m_params(p),
+            m_pinned(m),
+            m_num_rounds(0),
+            m_num_refined(0),
+            m_cancel(false) {
+            m_solver = mk_qffpa_tactic(m, p);
+            updt_params(p);
+        }
+
+        void updt_params(params_ref const & p) {
+            m_params    = p;
+            m_min_ebits = std::max(2u, p.get_uint("min_ebits", 3));
+            m_min_sbits = std::max(3u, p.get_uint("min_sbits", 4));
+            m_solver->updt_params(p);
+        }
+
+        void set_cancel(bool f) {
+            m_cancel = f;
+            m_solver->set_cancel(f);
+        }
+
+        void checkpoint() {
+            if (m_cancel)
+                throw tactic_exception(TACTIC_CANCELED_MSG);
+            cooperate("fpa-approx");
+        }
+
+        //
+        // Precision levels.
+        //
+
+        sort * get_approx_sort(sort * s, unsigned lvl) {
+            unsigned ebits = m_util.get_ebits(s);
+            unsigned sbits = m_util.get_sbits(s);
+            if (lvl < 16) {
+                ebits = std::min(ebits, m_min_ebits << lvl);
+                sbits = std::min(sbits, m_min_sbits << lvl);
+            }
+            return m_util.mk_float_sort(ebits, sbits);
+        }
+
+        unsigned get_level(app * t) const {
+            unsigned lvl = 0;
+            m_levels.find(t, lvl);
+            return lvl;
+        }
+
+        bool is_full(app * t) {
+            sort * s = get_sort(t);
+            return get_approx_sort(s, get_level(t)) == s;
+        }
+
+        bool widen(app * t) {
+            if (is_full(t))
+                return false;
+            m_levels.insert(t, get_level(t) + 1);
+            return true;
+        }
+
+        /**
+           \brief Return true if t is a floating-point term computed in reduced precision.
+        */
+        bool is_approximated(app * t) {
+            if (!m_util.is_float(get_sort(t)))
+                return false;
+            if (is_uninterp_const(t) || m.is_ite(t) || m_util.is_value(t))
+                return true;
+            if (t->get_family_id() != m_util.get_fid())
+                return false;
+            switch (t->get_decl_kind()) {
+            case OP_FLOAT_PLUS_INF:
+            case OP_FLOAT_MINUS_INF:
+            case OP_FLOAT_NAN:
+            case OP_FLOAT_ADD:
+            case OP_FLOAT_SUB:
+            case OP_FLOAT_UMINUS:
+            case OP_FLOAT_MUL:
+            case OP_FLOAT_DIV:
+            case OP_FLOAT_REM:
+            case OP_FLOAT_ABS:
+            case OP_FLOAT_MIN:
+            case OP_FLOAT_MAX:
+            case OP_FLOAT_FUSED_MA:
+            case OP_FLOAT_SQRT:
+            case OP_FLOAT_ROUND_TO_INTEGRAL:
+                return true;
+            case OP_TO_FLOAT:
+                return
+                    t->get_num_args() == 2 &&
+                    m_util.is_rm(get_sort(t->get_arg(0))) &&
+                    (m_util.au().is_real(t->get_arg(1)) || m_util.is_float(get_sort(t->get_arg(1))));
+            default:
+                return false;
+            }
+        }
+
+        //
+        // Construction of the approximated goal.
+        //
+
+        expr * coerce(expr * a, sort * s) {
+            if (get_sort(a) == s)
+                return a;
+            parameter ps[2] = { parameter(m_util.get_ebits(s)), parameter(m_util.get_sbits(s)) };
+            expr * args[2]  = { m_util.mk_round_nearest_ties_to_even(), a };
+            return m.mk_app(m_util.get_fid(), OP_TO_FLOAT, 2, ps, 2, args);
+        }
+
+        sort * mk_max_sort(unsigned num_args, expr * const * args) {
+            unsigned ebits = 0, sbits = 0;
+            for (unsigned i = 0; i < num_args; i++) {
+                sort * s = get_sort(args[i]);
+                ebits = std::max(ebits, m_util.get_ebits(s));
+                sbits = std::max(sbits, m_util.get_sbits(s));
+            }
+            return m_util.mk_float_sort(ebits, sbits);
+        }
+
+        /**
+           \brief Apply the declaration of t to args, converting floating-point
+           arguments to the (full precision) sorts expected by the declaration.
+        */
+        expr * mk_full(app * t, ptr_buffer<expr> & args) {
+            for (unsigned i = 0; i < args.size(); i++) {
+                if (m_util.is_float(get_sort(args[i])))
+                    args[i] = coerce(args[i], get_sort(t->get_arg(i)));
+            }
+            return m.mk_app(t->get_decl(), args.size(), args.c_ptr());
+        }
+
+        expr * mk_approx(app * t, ptr_buffer<expr> & args) {
+            sort * s = get_sort(t);
+            if (!m_util.is_float(s)) {
+                bool has_float = false;
+                for (unsigned i = 0; !has_float && i < args.size(); i++)
+                    has_float = m_util.is_float(get_sort(args[i]));
+                if (!has_float)
+                    return m.mk_app(t->get_decl(), args.size(), args.c_ptr());
+                if (m.is_eq(t) || m.is_distinct(t) ||
+                    (t->get_family_id() == m_util.get_fid() &&
+                     (t->get_decl_kind() == OP_FLOAT_EQ || t->get_decl_kind() == OP_FLOAT_LT ||
+                      t->get_decl_kind() == OP_FLOAT_GT || t->get_decl_kind() == OP_FLOAT_LE ||
+                      t->get_decl_kind() == OP_FLOAT_GE || t->get_decl_kind() == OP_FLOAT_IS_NAN ||
+                      t->get_decl_kind() == OP_FLOAT_IS_INF || t->get_decl_kind() == OP_FLOAT_IS_ZERO ||
+                      t->get_decl_kind() == OP_FLOAT_IS_PZERO || t->get_decl_kind() == OP_FLOAT_IS_NZERO ||
+                      t->get_decl_kind() == OP_FLOAT_IS_SIGN_MINUS))) {
+                    // exact comparison in the smallest common precision.
+                    sort * ms = mk_max_sort(args.size(), args.c_ptr());
+                    for (unsigned i = 0; i < args.size(); i++)
+                        args[i] = coerce(args[i], ms);
+                    if (t->get_family_id() == m_util.get_fid())
+                        return m.mk_app(m_util.get_fid(), t->get_decl_kind(), args.size(), args.c_ptr());
+                    if (m.is_eq(t))
+                        return m.mk_eq(args[0], args[1]);
+                    return m.mk_distinct(args.size(), args.c_ptr());
+                }
+                return mk_full(t, args);
+            }
+            if (!is_approximated(t))
+                return mk_full(t, args);
+            sort * as = get_approx_sort(s, get_level(t));
+            if (is_uninterp_const(t)) {
+                app * c = 0;
+                if (as == s)
+                    c = t;
+                else
+                    c = m.mk_fresh_const(t->get_decl()->get_name().str().c_str(), as);
+                m_pinned.push_back(c);
+                m_const2approx.insert(t, c);
+                return c;
+            }
+            scoped_mpf v(m_util.fm()), w(m_util.fm());
+            if (m_util.is_value(t, v)) {
+                m_util.fm().set(w, m_util.get_ebits(as), m_util.get_sbits(as), MPF_ROUND_NEAREST_TEVEN, v);
+                return m_util.mk_value(w);
+            }
+            if (m.is_ite(t))
+                return m.mk_ite(args[0], coerce(args[1], as), coerce(args[2], as));
+            if (t->get_decl_kind() == OP_TO_FLOAT) {
+                parameter ps[2] = { parameter(m_util.get_ebits(as)), parameter(m_util.get_sbits(as)) };
+                return m.mk_app(m_util.get_fid(), OP_TO_FLOAT, 2, ps, args.size(), args.c_ptr());
+            }
+            for (unsigned i = 0; i < args.size(); i++) {
+                if (m_util.is_float(get_sort(args[i])))
+                    args[i] = coerce(args[i], as);
+            }
+            return m.mk_app(m_util.get_fid(), t->get_decl_kind(), args.size(), args.c_ptr());
+        }
+
+        /**
+           \brief Collect the subterms of g in post-order.
+           Return false if g contains quantifiers or does not contain floating-point terms.
+        */
+        bool collect_subterms(goal const & g) {
+            m_subterms.reset();
+            bool has_float = false;
+            expr_fast_mark1 visited;
+            ptr_vector<expr> todo;
+            for (unsigned i = 0; i < g.size(); i++)
+                todo.push_back(g.form(i));
+            while (!todo.empty()) {
+                expr * e = todo.back();
+                if (visited.is_marked(e)) {
+                    todo.pop_back();
+                    continue;
+                }
+                if (!is_app(e))
+                    return false;
+                app * t = to_app(e);
+                bool visited_args = true;
+                for (unsigned i = 0; i < t->get_num_args(); i++) {
+                    if (!visited.is_marked(t->get_arg(i))) {
+                        todo.push_back(t->get_arg(i));
+                        visited_args = false;
+                    }
+                }
+                if (visited_args) {
+                    visited.mark(t);
+                    todo.pop_back();
+                    m_subterms.push_back(t);
+                    has_float = has_float || m_util.is_float(get_sort(t));
+                }
+            }
+            return has_float;
+        }
+
+        bool is_fully_precise() {
+            for (unsigned i = 0; i < m_subterms.size(); i++) {
+                app * t = m_subterms[i];
+                if (is_approximated(t) && !is_full(t))
+                    return false;
+            }
+            return true;
+        }
+
+        void mk_approx_goal(goal const & g, goal & r) {
+            m_approx.reset();
+            m_pinned.reset();
+            m_const2approx.reset();
+            ptr_buffer<expr> args;
+            for (unsigned i = 0; i < m_subterms.size(); i++) {
+                app * t = m_subterms[i];
+                args.reset();
+                for (unsigned j = 0; j < t->get_num_args(); j++)
+                    args.push_back(m_approx.find(t->get_arg(j)));
+                expr * a = mk_approx(t, args);
+                m_pinned.push_back(a);
+                m_approx.insert(t, a);
+            }
+            for (unsigned i = 0; i < g.size(); i++)
+                r.assert_expr(m_approx.find(g.form(i)));
+            TRACE("fpa_approx", r.display(tout););
+        }
+
+        //
+        // Refinement.
+        //
+
+        /**
+           \brief Evaluate the approximation of t in md, and convert the value to the sort of t.
+        */
+        void eval_lifted(model & md, expr * t, expr_ref & r) {
+            md.eval(m_approx.find(t), r, true);
+            scoped_mpf v(m_util.fm()), w(m_util.fm());
+            sort * s = get_sort(t);
+            if (m_util.is_float(s) && m_util.is_value(r, v)) {
+                m_util.fm().set(w, m_util.get_ebits(s), m_util.get_sbits(s), MPF_ROUND_NEAREST_TEVEN, v);
+                r = m_util.mk_value(w);
+            }
+        }
+
+        /**
+           \brief Return true if the value of the approximation of t in md is the value
+           of t at full precision applied to the values of the approximations of its arguments.
+        */
+        bool is_precise(model & md, app * t) {
+            expr_ref approx_val(m), full_val(m), arg_val(m);
+            eval_lifted(md, t, approx_val);
+            expr_ref_vector args(m);
+            for (unsigned i = 0; i < t->get_num_args(); i++) {
+                eval_lifted(md, t->get_arg(i), arg_val);
+                args.push_back(arg_val);
+            }
+            expr_ref full(m.mk_app(t->get_decl(), args.size(), args.c_ptr()), m);
+            md.eval(full, full_val, true);
+            scoped_mpf v(m_util.fm()), w(m_util.fm());
+            if (!m_util.is_value(approx_val, v) || !m_util.is_value(full_val, w))
+                return false;
+            TRACE("fpa_approx", tout << mk_pp(t, m) << "\napprox: " << mk_pp(approx_val, m) << "\nfull: " << mk_pp(full_val, m) << "\n";);
+            if (m_util.fm().is_nan(v) && m_util.fm().is_nan(w))
+                return true;
+            return m_util.fm().eq_core(v, w);
+        }
+
+        /**
+           \brief Widen the operations that are not precise in md.
+           Return false if all of them are precise.
+        */
+        bool refine(model & md) {
+            bool refined = false;
+            for (unsigned i = 0; i < m_subterms.size(); i++) {
+                checkpoint();
+                app * t = m_subterms[i];
+                if (is_approximated(t) && !is_uninterp_const(t) && !is_full(t) && !is_precise(md, t)) {
+                    widen(t);
+                    m_num_refined++;
+                    refined = true;
+                }
+            }
+            return refined;
+        }
+
+        void widen_all() {
+            for (unsigned i = 0; i < m_subterms.size(); i++) {
+                app * t = m_subterms[i];
+                if (is_approximated(t))
+                    widen(t);
+            }
+        }
+
+        /**
+           \brief Build a model for the original goal from the model of the approximated goal.
+        */
+        void mk_model(model & md, model_ref & r) {
+            r = alloc(model, m);
+            obj_hashtable<func_decl> approx_decls;
+            obj_map<app, app*>::iterator it  = m_const2approx.begin();
+            obj_map<app, app*>::iterator end = m_const2approx.end();
+            for (; it != end; ++it) {
+                expr_ref val(m);
+                eval_lifted(md, it->m_key, val);
+                r->register_decl(it->m_key->get_decl(), val);
+                approx_decls.insert(it->m_value->get_decl());
+            }
+            for (unsigned i = 0; i < md.get_num_constants(); i++) {
+                func_decl * c = md.get_constant(i);
+                if (!approx_decls.contains(c) && !r->get_const_interp(c))
+                    r->register_decl(c, md.get_const_interp(c));
+            }
+            for (unsigned i = 0; i < md.get_num_functions(); i++) {
+                func_decl * f = md.get_function(i);
+                r->register_decl(f, md.get_func_interp(f)->copy());
+            }
+        }
+
+        bool is_model(goal const & g, model & md) {
+            expr_ref val(m);
+            for (unsigned i = 0; i < g.size(); i++) {
+                md.eval(g.form(i), val, true);
+                if (!m.is_true(val)) {
+                    TRACE("fpa_approx", tout << "not satisfied: " << mk_pp(g.form(i), m) << "\n";);
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void operator()(goal_ref const & g,
+                        goal_ref_buffer & result,
+                        model_converter_ref & mc,
+                        proof_converter_ref & pc,
+                        expr_dependency_ref & core) {
+            SASSERT(g->is_well_sorted());
+            mc = 0; pc = 0; core = 0; result.reset();
+            tactic_report report("fpa-approx", *g);
+
+            if (g->inconsistent() || g->proofs_enabled() || g->unsat_core_enabled() || !collect_subterms(*g)) {
+                (*m_solver)(g, result, mc, pc, core);
+                return;
+            }
+            m_levels.reset();
+
+            while (!is_fully_precise()) {
+                checkpoint();
+                m_num_rounds++;
+                goal_ref approx_goal = alloc(goal, m, false, true, false);
+                mk_approx_goal(*g, *approx_goal);
+                model_ref md;
+                proof_ref pr(m);
+                expr_dependency_ref dep(m);
+                std::string reason_unknown;
+                lbool r = check_sat(*m_solver, approx_goal, md, pr, dep, reason_unknown);
+                IF_VERBOSE(TACTIC_VERBOSITY_LVL, verbose_stream() << "(fpa-approx :round " << m_num_rounds << " :result " << r << ")\n";);
+                if (r == l_undef)
+                    throw tactic_exception(reason_unknown.c_str());
+                if (r == l_false) {
+                    widen_all();
+                    continue;
+                }
+                if (refine(*md))
+                    continue;
+                model_ref full_md;
+                mk_model(*md, full_md);
+                if (!is_model(*g, *full_md)) {
+                    widen_all();
+                    continue;
+                }
+                g->reset();
+                g->inc_depth();
+                if (g->models_enabled())
+                    mc = model2model_converter(full_md.get());
+                result.push_back(g.get());
+                return;
+            }
+            // the approximation is the original goal.
+            m_approx.reset();
+            m_pinned.reset();
+            m_const2approx.reset();
+            (*m_solver)(g, result, mc, pc, core);
+        }
+    };
+
+    imp *      m_imp;
+    params_ref m_params;
+    statistics m_stats;
+
+public:
+    fpa_approx_tactic(ast_manager & m, params_ref const & p):
+        m_params(p) {
+        m_imp = alloc(imp, m, p);
+    }
+
+    virtual tactic * translate(ast_manager & m) {
+        return alloc(fpa_approx_tactic, m, m_params);
+    }
+
+    virtual ~fpa_approx_tactic() {
+        dealloc(m_imp);
+    }
+
+    virtual void updt_params(params_ref const & p) {
+        m_params = p;
+        m_imp->updt_params(p);
+    }
+
+    virtual void collect_param_descrs(param_descrs & r) {
+        r.insert("min_ebits", CPK_UINT, "(default: 3) number of exponent bits of the first approximation.");
+        r.insert("min_sbits", CPK_UINT, "(default: 4) number of significand bits of the first approximation.");
+    }
+
+    virtual void operator()(goal_ref const & in,
+                            goal_ref_buffer & result,
+                            model_converter_ref & mc,
+                            proof_converter_ref & pc,
+                            expr_dependency_ref & core) {
+        (*m_imp)(in, result, mc, pc, core);
+    }
+
+    virtual void collect_statistics(statistics & st) const {
+        st.update("fpa approx rounds", m_imp->m_num_rounds);
+        st.update("fpa approx refinements", m_imp->m_num_refined);
+    }
+
+    virtual void reset_statistics() {
+        m_imp->m_num_rounds  = 0;
+        m_imp->m_num_refined = 0;
+    }
+
+    virtual void cleanup() {
+        ast_manager & m = m_imp->m;
+        imp * d = m_imp;
+        #pragma omp critical (tactic_cancel)
+        {
+            d = m_imp;
+        }
+        dealloc(d);
+        d = alloc(imp, m, m_params);
+        #pragma omp critical (tactic_cancel)
+        {
+            m_imp = d;
+        }
+    }
+
+protected:
+    virtual void set_cancel(bool f) {
+        if (m_imp)
+            m_imp->set_cancel(f);
+    }
+};
+
+tactic * mk_fpa_approx_tactic(ast_manager & m, params_ref const & p) {
+    return clean(alloc(fpa_approx_tactic, m, p));
+}
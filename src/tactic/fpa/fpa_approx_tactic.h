@@ -0,0 +1,31 @@
+/*++
+Copyright (c) 2014 Microsoft Corporation
+
+Module Name:
+
+    fpa_approx_tactic.h
+
+Abstract:
+
+    Tactic that solves floating-point goals using reduced-precision
+    approximations that are refined until the candidate model is
+    valid at full precision.
+
+Author:
+
+Notes:
+
+--*/
+#ifndef _FPA_APPROX_TACTIC_H_
+#define _FPA_APPROX_TACTIC_H_
+
+#include"params.h"
+class ast_manager;
+class tactic;
+
+tactic * mk_fpa_approx_tactic(ast_manager & m, params_ref const & p = params_ref());
+/*
+  ADD_TACTIC("fpa-approx", "solve floating-point goals by refining reduced-precision approximations.", "mk_fpa_approx_tactic(m, p)")
+*/
+
+#endif
@@ -159,7 +159,7 @@ inline bool is_decided_unsat(GoalCollection const & c) { return c.size() == 1 &&
 
 template<typename ForEachProc>
 void for_each_expr_at(ForEachProc& proc, goal const & s) {
-    expr_mark visited;
+    expr_dense_mark visited(s.m());
     for (unsigned i = 0; i < s.size(); ++i) {
         for_each_expr(proc, visited, s.form(i));
     }
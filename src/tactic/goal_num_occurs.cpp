@@ -19,7 +19,7 @@ Revision History:
 #include"goal.h"
 
 void goal_num_occurs::operator()(goal const & g) {
-    expr_fast_mark1   visited;
+    expr_dense_mark visited(m);
     unsigned sz = g.size();
     for (unsigned i = 0; i < sz; i++) {
         process(g.form(i), visited);
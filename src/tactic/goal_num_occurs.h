@@ -24,8 +24,8 @@ class goal;
 
 class goal_num_occurs : public num_occurs { 
 public:
-    goal_num_occurs(bool ignore_ref_count1 = false, bool ignore_quantifiers = false):
-        num_occurs(ignore_ref_count1, ignore_quantifiers) {
+    goal_num_occurs(ast_manager & m, bool ignore_ref_count1 = false, bool ignore_quantifiers = false):
+        num_occurs(m, ignore_ref_count1, ignore_quantifiers) {
     }
 
     void operator()(goal const & s);
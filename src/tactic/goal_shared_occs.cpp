@@ -20,7 +20,7 @@ Revision History:
 
 void goal_shared_occs::operator()(goal const & g) {
     m_occs.reset();
-    shared_occs_mark visited;
+    expr_dense_mark visited(g.m());
     unsigned sz = g.size();
     for (unsigned i = 0; i < sz; i++) {
         expr * t = g.form(i);
@@ -17,6 +17,7 @@ Revision History:
 
 --*/
 #include "ast.h"
+#include "z3_omp.h"
 
 static void tst1() {
     ast_manager m;
@@ -131,6 +132,100 @@ static void tst5() {
     m.del(arr3);
 }
 
+static void tst6() {
+    // threads sharing a manager in concurrent mode
+    ast_manager m;
+    sort_ref b(m.mk_bool_sort(), m);
+    expr_ref a(m.mk_const(symbol("a"), b.get()), m);
+    expr_ref c(m.mk_const(symbol("c"), b.get()), m);
+    m.enable_concurrency();
+    unsigned num_asts = m.get_num_asts();
+    int num_threads = 4;
+    ptr_vector<expr> results;
+    ptr_vector<expr> fresh;
+    results.resize(num_threads, 0);
+    fresh.resize(num_threads, 0);
+    #pragma omp parallel for 
+    for (int i = 0; i < num_threads; ++i) {
+        expr_ref r(a, m);
+        for (unsigned j = 0; j < 1000; ++j) {
+            r = m.mk_and(r, m.mk_or(c, m.mk_not(r)));
+        }
+        m.inc_ref(r);
+        results[i] = r;
+        expr * x = m.mk_fresh_const("x", m.mk_bool_sort());
+        m.inc_ref(x);
+        fresh[i] = x;
+    }
+    for (int i = 0; i < num_threads; ++i) {
+        SASSERT(results[i] == results[0]);
+        for (int j = 0; j < i; ++j) {
+            SASSERT(fresh[i] != fresh[j]);
+        }
+    }
+    m.dec_array_ref(num_threads, results.c_ptr());
+    m.dec_array_ref(num_threads, fresh.c_ptr());
+    m.collect();
+    SASSERT(m.get_num_asts() == num_asts);
+}
+
+static void tst7() {
+    // deferred deletion processed in bounded batches
+    ast_manager m;
+    m.enable_deferred_deletion(true);
+    sort_ref b(m.mk_bool_sort(), m);
+    expr_ref a(m.mk_const(symbol("a"), b.get()), m);
+    unsigned num_asts = m.get_num_asts();
+    expr_ref r(a, m);
+    for (unsigned j = 0; j < 100; ++j) {
+        r = m.mk_not(r);
+    }
+    expr_ref keep(to_app(r)->get_arg(0), m);
+    r = 0;
+    SASSERT(m.has_deferred_deletions());
+    SASSERT(m.get_num_asts() == num_asts + 100);
+    m.collect(1);
+    SASSERT(m.get_num_asts() == num_asts + 99);
+    keep = 0;
+    // reuse a node that is waiting to be deleted
+    r = m.mk_not(a);
+    m.collect(10);
+    SASSERT(m.get_num_asts() == num_asts + 89);
+    m.collect();
+    SASSERT(!m.has_deferred_deletions());
+    SASSERT(m.get_num_asts() == num_asts + 1);
+    r = 0;
+    m.enable_deferred_deletion(false);
+    SASSERT(m.get_num_asts() == num_asts);
+}
+
+static void tst8() {
+    // stamp tables of the manager are reused, and marks do not interfere
+    ast_manager m;
+    sort_ref b(m.mk_bool_sort(), m);
+    expr_ref a(m.mk_const(symbol("a"), b.get()), m);
+    expr_ref na(m.mk_not(a), m);
+    {
+        expr_dense_mark m1(m);
+        m1.mark(a);
+        SASSERT(m1.is_marked(a) && !m1.is_marked(na));
+        {
+            expr_dense_mark m2(m);
+            SASSERT(!m2.is_marked(a));
+            m2.mark(na);
+            SASSERT(!m1.is_marked(na));
+        }
+        m1.mark(a, false);
+        SASSERT(!m1.is_marked(a));
+        m1.mark(na);
+        m1.reset();
+        SASSERT(!m1.is_marked(na));
+        m1.mark(na);
+    }
+    // m3 reuses one of the tables released above
+    expr_dense_mark m3(m);
+    SASSERT(!m3.is_marked(a) && !m3.is_marked(na));
+}
 
 struct foo {
     unsigned       m_id; 
@@ -153,5 +248,8 @@ void tst_ast() {
     tst3();
     tst4();
     tst5();
+    tst6();
+    tst7();
+    tst8();
 }
 
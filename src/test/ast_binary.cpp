@@ -0,0 +1,136 @@
+/*++
+Copyright (c) 2015 Microsoft Corporation
+
+Module Name:
+
+    ast_binary.cpp
+
+Abstract:
+
+    Test the binary AST format.
+
+Revision History:
+
+--*/
+#include<fstream>
+#include<sstream>
+#include"ast_binary.h"
+#include"ast_smt2_pp.h"
+#include"reg_decl_plugins.h"
+#include"smt2parser.h"
+#include"stopwatch.h"
+
+static char const * g_example =
+    "(declare-sort U)\n"
+    "(declare-fun f (U Int) U)\n"
+    "(declare-fun p (U) Bool)\n"
+    "(declare-const u U)\n"
+    "(declare-const x Int)\n"
+    "(declare-const y Real)\n"
+    "(declare-const b (_ BitVec 8))\n"
+    "(declare-const a (Array Int (_ BitVec 8)))\n"
+    "(declare-datatypes () ((L nil (cons (hd Int) (tl L)))))\n"
+    "(declare-const l L)\n"
+    "(assert (p (f (f u x) (+ x 123456789012345678901234567890))))\n"
+    "(assert (< (* 2 y) (/ 1 3)))\n"
+    "(assert (= (select (store a x b) (- x 1)) (bvadd b #x0f)))\n"
+    "(assert (and (is-cons l) (> (hd l) (- 5)) (= (tl l) nil)))\n"
+    "(assert (forall ((v U) (i Int)) (! (=> (p v) (p (f v i))) :pattern ((f v i)) :qid q1)))\n"
+    "(assert (exists ((z Int)) (and (< x z) (< z (+ x 2)))))\n"
+    "(assert (distinct x 1 2 3))\n";
+
+static void parse(ast_manager & m, std::istream & is, ast_ref_vector & result) {
+    cmd_context ctx(false, &m);
+    ctx.set_ignore_check(true);
+    VERIFY(parse_smt2_commands(ctx, is));
+    ptr_vector<expr>::const_iterator it  = ctx.begin_assertions();
+    ptr_vector<expr>::const_iterator end = ctx.end_assertions();
+    for (; it != end; ++it)
+        result.push_back(*it);
+}
+
+static std::string to_string(ast_manager & m, ast_ref_vector const & asts) {
+    std::ostringstream strm;
+    for (unsigned i = 0; i < asts.size(); i++)
+        strm << mk_ismt2_pp(asts.get(i), m) << "\n";
+    return strm.str();
+}
+
+void tst_ast_binary() {
+    ast_manager m;
+    reg_decl_plugins(m);
+    ast_ref_vector asts(m);
+    std::istringstream is(g_example);
+    parse(m, is, asts);
+    SASSERT(asts.size() == 7);
+
+    std::ostringstream out;
+    ast_binary_write(m, asts.size(), asts.c_ptr(), out);
+    std::string data = out.str();
+    SASSERT(is_ast_binary(data.c_str(), data.size()));
+
+    // reading into the same manager produces the same ASTs
+    ast_ref_vector asts2(m);
+    ast_binary_read(m, data.c_str(), data.size(), asts2);
+    SASSERT(asts2.size() == asts.size());
+    for (unsigned i = 0; i < asts.size(); i++) {
+        SASSERT(asts.get(i) == asts2.get(i));
+    }
+
+    // reading into a different manager
+    {
+        ast_manager m3;
+        reg_decl_plugins(m3);
+        ast_ref_vector asts3(m3);
+        ast_binary_read(m3, data.c_str(), data.size(), asts3);
+        SASSERT(to_string(m, asts) == to_string(m3, asts3));
+        std::cout << to_string(m3, asts3);
+    }
+
+    // truncated input must be rejected
+    for (unsigned sz = 0; sz < data.size(); sz += 7) {
+        ast_manager m4;
+        reg_decl_plugins(m4);
+        ast_ref_vector asts4(m4);
+        bool ok = true;
+        try {
+            ast_binary_read(m4, data.c_str(), sz, asts4);
+        }
+        catch (z3_exception &) {
+            ok = false;
+        }
+        SASSERT(!ok);
+    }
+}
+
+// Usage: test-z3 ast_binary_bench file.smt2
+// Compare the time needed to parse the assertions in the given file, and to load them from the binary format.
+void tst_ast_binary_bench(char ** argv, int argc, int & i) {
+    if (i + 1 >= argc) {
+        std::cerr << "expected an SMT 2.0 file\n";
+        return;
+    }
+    char const * file_name = argv[i+1];
+    i++;
+    stopwatch sw;
+    ast_manager m1;
+    reg_decl_plugins(m1);
+    ast_ref_vector asts(m1);
+    std::ifstream in(file_name);
+    sw.start();
+    parse(m1, in, asts);
+    sw.stop();
+    double parse_time = sw.get_seconds();
+    std::ostringstream out;
+    ast_binary_write(m1, asts.size(), asts.c_ptr(), out);
+    std::string data = out.str();
+    ast_manager m2;
+    reg_decl_plugins(m2);
+    ast_ref_vector asts2(m2);
+    sw.reset();
+    sw.start();
+    ast_binary_read(m2, data.c_str(), data.size(), asts2);
+    sw.stop();
+    std::cout << "(ast-binary-bench :assertions " << asts.size() << " :asts " << m1.get_num_asts()
+              << " :bytes " << data.size() << " :parse-time " << parse_time << " :load-time " << sw.get_seconds() << ")\n";
+}
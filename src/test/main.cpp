@@ -138,6 +138,8 @@ int main(int argc, char ** argv) {
     TST(rational);
     TST(inf_rational);
     TST(ast);
+    TST(ast_binary);
+    TST_ARGV(ast_binary_bench);
     TST(optional);
     TST(bit_vector);
     TST(string_buffer);
@@ -161,6 +163,8 @@ int main(int argc, char ** argv) {
     TST(matcher);
     TST(object_allocator);
     TST(mpz);
+    TST(mpn);
+    TST_ARGV(mpn_bench);
     TST(mpq);
     TST(mpf);
     TST(total_order);
@@ -0,0 +1,155 @@
+/*++
+Copyright (c) 2015 Microsoft Corporation
+
+Module Name:
+
+    mpn.cpp
+
+Abstract:
+
+    Test multi precision natural numbers: Karatsuba multiplication and
+    divide and conquer division against the schoolbook algorithms.
+
+Revision History:
+
+--*/
+#include<stdlib.h>
+#include"mpz.h"
+#include"stopwatch.h"
+#include"buffer.h"
+#include"mpn.h"
+
+typedef sbuffer<mpn_digit> digits;
+
+static void random_digits(digits & r, unsigned sz) {
+    r.reset();
+    for (unsigned i = 0; i < sz; i++)
+        r.push_back((static_cast<mpn_digit>(rand()) << 16) ^ static_cast<mpn_digit>(rand()));
+    // force extreme values now and then
+    if (sz > 0 && rand() % 4 == 0)
+        r[sz-1] = rand() % 2 == 0 ? 1 : static_cast<mpn_digit>(-1);
+    if (sz > 1 && rand() % 4 == 0)
+        for (unsigned i = 0; i < sz/2; i++)
+            r[i] = static_cast<mpn_digit>(-1);
+    if (sz > 0 && r[sz-1] == 0)
+        r[sz-1] = 1;
+}
+
+// c += a * b[j] * 2^(32*j) for all j, one digit of b at a time.
+static void mul_reference(mpn_manager & m, digits const & a, digits const & b, digits & c) {
+    unsigned sz = a.size() + b.size();
+    c.reset();
+    c.resize(sz, 0);
+    digits t(a.size() + 1, 0);
+    for (unsigned j = 0; j < b.size(); j++) {
+        m.mul(a.c_ptr(), a.size(), b.c_ptr() + j, 1, t.c_ptr());
+        uint64 k = 0;
+        for (unsigned i = 0; i + j < sz; i++) {
+            k += static_cast<uint64>(c[i + j]) + (i < t.size() ? t[i] : 0);
+            c[i + j] = static_cast<mpn_digit>(k);
+            k >>= 32;
+        }
+        SASSERT(k == 0);
+    }
+}
+
+static void tst_mul(mpn_manager & m, unsigned sz_a, unsigned sz_b) {
+    digits a, b, c, expected;
+    random_digits(a, sz_a);
+    random_digits(b, sz_b);
+    c.resize(sz_a + sz_b, 0);
+    m.mul(a.c_ptr(), sz_a, b.c_ptr(), sz_b, c.c_ptr());
+    mul_reference(m, a, b, expected);
+    for (unsigned i = 0; i < sz_a + sz_b; i++) {
+        CTRACE("mpn", c[i] != expected[i], tout << "mul " << sz_a << " x " << sz_b << " differs at " << i << "\n";);
+        SASSERT(c[i] == expected[i]);
+    }
+}
+
+// numer = a * b + r, where r < b. Then numer / b must be a, and numer % b must be r.
+static void tst_div(mpn_manager & m, unsigned sz_a, unsigned sz_b) {
+    digits a, b, r, numer, q, rem;
+    random_digits(a, sz_a);
+    random_digits(b, sz_b);
+    random_digits(r, sz_b);
+    r[sz_b-1] = b[sz_b-1] > 0 ? b[sz_b-1] - 1 : 0;
+    numer.resize(sz_a + sz_b, 0);
+    m.mul(a.c_ptr(), sz_a, b.c_ptr(), sz_b, numer.c_ptr());
+    digits t(sz_a + sz_b + 1, 0);
+    size_t lt;
+    m.add(numer.c_ptr(), numer.size(), r.c_ptr(), r.size(), t.c_ptr(), t.size(), &lt);
+    SASSERT(t[sz_a + sz_b] == 0);
+    unsigned lnum = sz_a + sz_b;
+    while (lnum > 1 && t[lnum-1] == 0)
+        lnum--;
+    q.resize(lnum - sz_b + 1, 0);
+    rem.resize(sz_b, 0);
+    m.div(t.c_ptr(), lnum, b.c_ptr(), sz_b, q.c_ptr(), rem.c_ptr());
+    for (unsigned i = 0; i < q.size(); i++) {
+        SASSERT(q[i] == (i < sz_a ? a[i] : 0));
+    }
+    for (unsigned i = 0; i < sz_b; i++) {
+        SASSERT(rem[i] == r[i]);
+    }
+}
+
+void tst_mpn() {
+    mpn_manager m;
+    unsigned sizes[] = { 1, 2, 5, 31, 32, 33, 47, 48, 49, 64, 95, 100, 150, 257, 600 };
+    unsigned num_sizes = sizeof(sizes)/sizeof(unsigned);
+    for (unsigned i = 0; i < num_sizes; i++) {
+        for (unsigned j = 0; j < num_sizes; j++) {
+            tst_mul(m, sizes[i], sizes[j]);
+            if (sizes[j] > 1)
+                tst_div(m, sizes[i], sizes[j]);
+        }
+    }
+    for (unsigned i = 0; i < 200; i++) {
+        unsigned sz_a = 1 + rand() % 400;
+        unsigned sz_b = 2 + rand() % 400;
+        tst_mul(m, sz_a, sz_b);
+        tst_div(m, sz_a, sz_b);
+    }
+}
+
+static double bench_op(unsynch_mpz_manager & m, mpz const & a, mpz const & b, mpz & c, bool div) {
+    stopwatch sw;
+    unsigned n = 0;
+    sw.start();
+    do {
+        for (unsigned i = 0; i < 16; i++) {
+            if (div)
+                m.machine_div(a, b, c);
+            else
+                m.mul(a, b, c);
+        }
+        n += 16;
+    }
+    while (sw.get_current_seconds() < 0.2);
+    sw.stop();
+    return sw.get_seconds() * 1000000.0 / n;
+}
+
+// Usage: test-z3 mpn_bench [max-digits]
+// Compare the timings of a build using GMP (_MP_GMP) with one using the internal library.
+void tst_mpn_bench(char ** argv, int argc, int & i) {
+    unsigned max_sz = 4096;
+    if (i + 1 < argc) {
+        max_sz = atoi(argv[i+1]);
+        i++;
+    }
+    unsynch_mpz_manager m;
+    scoped_mpz a(m), b(m), c(m);
+    digits da, db;
+    for (unsigned sz = 8; sz <= max_sz; sz *= 2) {
+        random_digits(da, sz);
+        random_digits(db, sz);
+        m.set(a, sz, da.c_ptr());
+        m.set(b, sz, db.c_ptr());
+        double mul_us = bench_op(m, a, b, c, false);
+        m.mul(a, b, c);
+        m.add(c, a, c);
+        double div_us = bench_op(m, c, b, a, true);
+        std::cout << "(mpn-bench :digits " << sz << " :mul-us " << mul_us << " :div-us " << div_us << ")" << std::endl;
+    }
+}
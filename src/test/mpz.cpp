@@ -291,6 +291,49 @@ void tst_int_min_bug() {
     m.del(r);
 }
 
+static void tst_small_int64() {
+    unsynch_mpz_manager m;
+    scoped_mpz a(m), b(m), c(m), expected(m);
+    // 2^63 - 1 is the largest small number
+    m.set(a, INT64_MAX);
+    SASSERT(m.is_small(a));
+    m.add(a, mpz(1), c);
+    m.set(expected, "9223372036854775808");
+    SASSERT(!m.is_small(c) && m.eq(c, expected) && !m.is_int64(c));
+    m.sub(c, mpz(1), c);
+    SASSERT(m.is_small(c) && m.eq(c, a));
+    // INT64_MIN is not small
+    m.set(a, INT64_MIN);
+    SASSERT(!m.is_small(a) && m.is_int64(a) && m.get_int64(a) == INT64_MIN);
+    m.neg(a);
+    SASSERT(m.eq(a, expected));
+    m.neg(a);
+    m.add(a, mpz(1), a);
+    SASSERT(m.is_small(a) && m.get_int64(a) == -INT64_MAX);
+    // products near the boundary
+    m.set(a, static_cast<int64>(3037000499ll));
+    m.mul(a, a, c);
+    m.set(expected, "9223372030926249001");
+    SASSERT(m.is_small(c) && m.eq(c, expected));
+    m.set(a, static_cast<int64>(-3037000500ll));
+    m.mul(a, a, c);
+    m.set(expected, "9223372037000250000");
+    SASSERT(!m.is_small(c) && m.eq(c, expected));
+    m.mul(c, mpz(-1), c);
+    m.div(c, a, b);
+    SASSERT(m.is_small(b) && m.get_int64(b) == 3037000500ll);
+    // shifts
+    m.set(a, 3);
+    m.mul2k(a, 61, c);
+    m.set(expected, "6917529027641081856");
+    SASSERT(m.is_small(c) && m.eq(c, expected));
+    m.mul2k(a, 62, c);
+    SASSERT(!m.is_small(c));
+    m.machine_div2k(c, 62);
+    SASSERT(m.is_small(c) && m.eq(c, a));
+    std::cout << "small int64: " << c << " " << expected << "\n";
+}
+
 void tst_scoped() {
     synch_mpz_manager m;
     scoped_synch_mpz a(m);
@@ -502,6 +545,7 @@ void tst_mpz() {
     // tst_gcd();
     tst_scoped();
     tst_int_min_bug();
+    tst_small_int64();
     bug4();
     bug3();
     bug1();
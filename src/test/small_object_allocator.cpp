@@ -2,6 +2,7 @@
 #include"util.h"
 #include"trace.h"
 #include"small_object_allocator.h"
+#include"vector.h"
 
 void tst_small_object_allocator() {
     small_object_allocator soa;
@@ -31,4 +32,17 @@ void tst_small_object_allocator() {
     TRACE("small_object_allocator", 
           tout << "r1: " << (void*)r1 << " r2: " << (void*)r2 << " r3: " << (void*)r3 << " r4: " << (void*)r4 << "\n";);
 
+    // chunks containing only free objects are returned to the memory manager
+    small_object_allocator soa2;
+    ptr_vector<char> objs;
+    for (unsigned i = 0; i < 100000; i++) 
+        objs.push_back(new (soa2) char[24]);
+    for (unsigned i = 0; i < objs.size(); i += 2)
+        soa2.deallocate(24, objs[i]);
+    for (unsigned i = 1; i < objs.size(); i += 2)
+        soa2.deallocate(24, objs[i]);
+    TRACE("small_object_allocator", soa2.display_statistics(tout););
+    SASSERT(soa2.get_num_free_objs() < 100000);
+    SASSERT(soa2.get_allocation_size() == 0);
 }
+
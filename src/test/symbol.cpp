@@ -17,8 +17,11 @@ Revision History:
 
 --*/
 #include<iostream>
+#include<sstream>
 #include"symbol.h"
 #include"debug.h"
+#include"vector.h"
+#include"z3_omp.h"
 
 static void tst1() {
     symbol s1("foo");
@@ -51,8 +54,35 @@ static void tst1() {
     SASSERT(lt(symbol("zzz"), symbol("zzzb")));
 }
 
+static symbol mk_tst_symbol(unsigned j) {
+    std::ostringstream strm;
+    strm << "tst_symbol_" << j;
+    return symbol(strm.str().c_str());
+}
+
+// Threads intern overlapping sets of strings; all of them must get the same symbols.
+static void tst2() {
+    unsigned const num_threads = 4;
+    unsigned const num_syms    = 5000;
+    vector<svector<symbol> > syms(num_threads);
+    #pragma omp parallel for num_threads(num_threads)
+    for (int t = 0; t < static_cast<int>(num_threads); t++) {
+        for (unsigned i = 0; i < num_syms; i++) {
+            unsigned j = (i * (2*t + 1)) % num_syms;
+            syms[t].push_back(mk_tst_symbol(j));
+        }
+    }
+    for (unsigned t = 0; t < num_threads; t++) {
+        for (unsigned i = 0; i < num_syms; i++) {
+            unsigned j = (i * (2*t + 1)) % num_syms;
+            SASSERT(syms[t][i] == mk_tst_symbol(j));
+        }
+    }
+}
+
 void tst_symbol() {
     tst1();
+    tst2();
 }
 
 
@@ -28,6 +28,7 @@ void env_params::updt_params() {
     enable_warning_messages(p.get_bool("warning", true));
     memory::set_max_size(megabytes_to_bytes(p.get_uint("memory_max_size", 0)));
     memory::set_high_watermark(p.get_uint("memory_high_watermark", 0));
+    memory::set_thread_slack(p.get_uint("memory_thread_slack", 100) * 1024);
 }
 
 void env_params::collect_param_descrs(param_descrs & d) {
@@ -35,4 +36,5 @@ void env_params::collect_param_descrs(param_descrs & d) {
     d.insert("warning", CPK_BOOL, "enable/disable warning messages", "true");
     d.insert("memory_max_size", CPK_UINT, "set hard upper limit for memory consumption (in megabytes), if 0 then there is no limit", "0");
     d.insert("memory_high_watermark", CPK_UINT, "set high watermark for memory consumption (in megabytes), if 0 then there is no limit", "0");
+    d.insert("memory_thread_slack", CPK_UINT, "amount of memory (in kilobytes) a thread may allocate or release before its usage is merged into the global counter; memory_max_size may be exceeded by this amount per thread", "100");
 }
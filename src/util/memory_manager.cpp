@@ -119,6 +119,16 @@ void memory::set_max_size(size_t max_size) {
     g_memory_max_size = max_size;
 }
 
+// We only integrate the local thread counters with the global one
+// when the absolute value of the local counter exceeds g_memory_thread_slack.
+// So, each thread may exceed the maximum size by at most g_memory_thread_slack bytes.
+static long long  g_memory_thread_slack      = 100000;
+
+void memory::set_thread_slack(size_t slack) {
+    // This method is only safe to invoke at initialization time, that is, before the threads are created.
+    g_memory_thread_slack = slack;
+}
+
 static bool g_finalizing = false;
 
 void memory::finalize() {
@@ -182,11 +192,6 @@ void * memory::allocate(char const* file, int line, char const* obj, size_t s) {
 // ==================================
 // ==================================
 
-
-// We only integrate the local thread counters with the global one
-// when the local counter > SYNCH_THRESHOLD 
-#define SYNCH_THRESHOLD 100000
-
 #ifdef _WINDOWS
 // Actually this is VS specific instead of Windows specific.
 __declspec(thread) long long g_memory_thread_alloc_size    = 0;
@@ -221,7 +226,7 @@ void memory::deallocate(void * p) {
     void * real_p  = reinterpret_cast<void*>(sz_p);
     g_memory_thread_alloc_size -= sz;
     free(real_p);
-    if (g_memory_thread_alloc_size < -SYNCH_THRESHOLD) {
+    if (g_memory_thread_alloc_size < -g_memory_thread_slack) {
         synchronize_counters(false);
     }
 }
@@ -235,7 +240,7 @@ void * memory::allocate(size_t s) {
         throw_out_of_memory();
     *(static_cast<size_t*>(r)) = s;
     g_memory_thread_alloc_size += s;
-    if (g_memory_thread_alloc_size > SYNCH_THRESHOLD) {
+    if (g_memory_thread_alloc_size > g_memory_thread_slack) {
         synchronize_counters(true);
     }
     return static_cast<size_t*>(r) + 1; // we return a pointer to the location after the extra field
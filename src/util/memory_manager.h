@@ -35,6 +35,7 @@ public:
     static void set_high_watermark(size_t watermak);
     static bool above_high_watermark();
     static void set_max_size(size_t max_size);
+    static void set_thread_slack(size_t slack);
     static void finalize();
     static void display_max_usage(std::ostream& os);
     static void display_i_max_usage(std::ostream& os);
@@ -310,7 +310,7 @@ void mpf_manager::set(mpf & o, unsigned ebits, unsigned sbits, mpf_rounding_mode
             m_mpq_manager.mul(sig, 2, sig);
         }
 	
-        if (m_mpz_manager.is_small(exp)) {
+        if (m_mpz_manager.is_int(exp)) {
             o.exponent = m_mpz_manager.get_int64(exp);
             round(rm, o);
         }
@@ -115,19 +115,89 @@ bool mpn_manager::sub(mpn_digit const * a, size_t const lnga,
     return true; // return k != 0?
 }
 
-bool mpn_manager::mul(mpn_digit const * a, size_t const lnga,
-                      mpn_digit const * b, size_t const lngb,
-                      mpn_digit * c) const {
-    trace(a, lnga, b, lngb, "*");
-    // Essentially Knuth's Algorithm M. 
-    // Perhaps implement a more efficient version, see e.g., Knuth, Section 4.3.3.    
-    size_t i;
-    mpn_digit k;
-
 #define DIGIT_BITS (sizeof(mpn_digit)*8)
 #define HALF_BITS (sizeof(mpn_digit)*4)
 
-    for (unsigned i = 0; i < lnga; i++)
+// Operands with fewer digits than this are multiplied using the schoolbook method.
+#define KARATSUBA_THRESHOLD 32
+// Divisors and quotients with fewer digits than this are computed using Knuth's Algorithm D.
+#define DIV_DC_THRESHOLD 48
+
+// c[0..la) <- a[0..la) + b[0..lb), where la >= lb, and c may be equal to a. Return the carry.
+static mpn_digit add_n(mpn_digit * c, mpn_digit const * a, size_t la, mpn_digit const * b, size_t lb) {
+    SASSERT(la >= lb);
+    mpn_double_digit k = 0;
+    size_t i = 0;
+    for (; i < lb; i++) {
+        k += (mpn_double_digit)a[i] + (mpn_double_digit)b[i];
+        c[i] = (mpn_digit)k;
+        k >>= DIGIT_BITS;
+    }
+    for (; i < la; i++) {
+        k += (mpn_double_digit)a[i];
+        c[i] = (mpn_digit)k;
+        k >>= DIGIT_BITS;
+    }
+    return (mpn_digit)k;
+}
+
+// a[0..la) <- a[0..la) - b[0..lb), where la >= lb. Return the borrow.
+static mpn_digit sub_in_place(mpn_digit * a, size_t la, mpn_digit const * b, size_t lb) {
+    SASSERT(la >= lb);
+    mpn_digit k = 0;
+    size_t i = 0;
+    for (; i < lb; i++) {
+        mpn_digit u = a[i];
+        mpn_digit r = u - b[i];
+        mpn_digit c1 = r > u;
+        a[i] = r - k;
+        k = c1 | (a[i] > r);
+    }
+    for (; i < la && k != 0; i++) {
+        k = a[i] == 0;
+        a[i]--;
+    }
+    return k;
+}
+
+// a[0..la) <- a[0..la) - 1. Return the borrow.
+static mpn_digit dec_in_place(mpn_digit * a, size_t la) {
+    for (size_t i = 0; i < la; i++) {
+        if (a[i]-- != 0)
+            return 0;
+    }
+    return 1;
+}
+
+// a[0..n) <- a[0..n) - b[0..n) * v. Return the borrow digit.
+static mpn_digit submul_1(mpn_digit * a, mpn_digit const * b, size_t n, mpn_digit v) {
+    mpn_digit k = 0;
+    for (size_t i = 0; i < n; i++) {
+        mpn_double_digit p = (mpn_double_digit)b[i] * (mpn_double_digit)v + (mpn_double_digit)k;
+        mpn_digit lo = (mpn_digit)p;
+        mpn_digit u  = a[i];
+        a[i] = u - lo;
+        k = (mpn_digit)(p >> DIGIT_BITS) + (u < lo);
+    }
+    return k;
+}
+
+static int compare_n(mpn_digit const * a, mpn_digit const * b, size_t n) {
+    for (size_t i = n; i-- > 0; ) {
+        if (a[i] != b[i])
+            return a[i] > b[i] ? 1 : -1;
+    }
+    return 0;
+}
+
+// Essentially Knuth's Algorithm M. c must not overlap a or b.
+static void mul_basecase(mpn_digit const * a, size_t const lnga,
+                         mpn_digit const * b, size_t const lngb,
+                         mpn_digit * c) {
+    size_t i;
+    mpn_digit k;
+
+    for (i = 0; i < lnga; i++)
         c[i] = 0;
 
     for (size_t j = 0; j < lngb; j++) {        
@@ -150,7 +220,77 @@ bool mpn_manager::mul(mpn_digit const * a, size_t const lnga,
             c[j+lnga] = k;
         }        
     }
-    
+}
+
+// Size of the workspace used by karatsuba for n-digit operands.
+static size_t karatsuba_scratch(size_t n) {
+    size_t r = 0;
+    while (n >= KARATSUBA_THRESHOLD) {
+        size_t m = n - n/2;
+        r += 4*(m+1);
+        n  = m+1;
+    }
+    return r;
+}
+
+// c[0..2n) <- a[0..n) * b[0..n) using Karatsuba's method.
+// ws is a workspace of karatsuba_scratch(n) digits.
+static void karatsuba(mpn_digit const * a, mpn_digit const * b, size_t n, mpn_digit * c, mpn_digit * ws) {
+    if (n < KARATSUBA_THRESHOLD) {
+        mul_basecase(a, n, b, n, c);
+        return;
+    }
+    // a = a1*B^h + a0, b = b1*B^h + b0
+    size_t h = n/2;
+    size_t m = n - h;
+    karatsuba(a, b, h, c, ws);                 // a0*b0
+    karatsuba(a + h, b + h, m, c + 2*h, ws);   // a1*b1
+    mpn_digit * sa = ws;
+    mpn_digit * sb = ws + (m+1);
+    mpn_digit * t  = ws + 2*(m+1);
+    sa[m] = add_n(sa, a + h, m, a, h);
+    sb[m] = add_n(sb, b + h, m, b, h);
+    karatsuba(sa, sb, m+1, t, ws + 4*(m+1));   // (a0 + a1)*(b0 + b1)
+    sub_in_place(t, 2*(m+1), c, 2*h);
+    sub_in_place(t, 2*(m+1), c + 2*h, 2*m);
+    // the middle term a0*b1 + a1*b0 fits in h + m + 1 digits
+    DEBUG_CODE(for (size_t i = h + m + 1; i < 2*(m+1); i++) SASSERT(t[i] == 0););
+    add_n(c + h, c + h, h + 2*m, t, h + m + 1);
+}
+
+static void mul_core(mpn_digit const * a, size_t la, mpn_digit const * b, size_t lb, mpn_digit * c) {
+    if (la < lb) {
+        std::swap(a, b);
+        std::swap(la, lb);
+    }
+    if (lb < KARATSUBA_THRESHOLD) {
+        mul_basecase(a, la, b, lb, c);
+        return;
+    }
+    sbuffer<mpn_digit> ws(static_cast<unsigned>(2*lb + karatsuba_scratch(lb)), 0);
+    if (la == lb) {
+        karatsuba(a, b, lb, c, ws.c_ptr());
+        return;
+    }
+    // split a into chunks of lb digits.
+    mpn_digit * t = ws.c_ptr();
+    for (size_t i = 0; i < la + lb; i++)
+        c[i] = 0;
+    for (size_t i = 0; i < la; i += lb) {
+        size_t lc = la - i < lb ? la - i : lb;
+        if (lc == lb) 
+            karatsuba(a + i, b, lb, t, ws.c_ptr() + 2*lb);
+        else 
+            mul_core(b, lb, a + i, lc, t);
+        add_n(c + i, c + i, la + lb - i, t, lb + lc);
+    }
+}
+
+bool mpn_manager::mul(mpn_digit const * a, size_t const lnga,
+                      mpn_digit const * b, size_t const lngb,
+                      mpn_digit * c) const {
+    trace(a, lnga, b, lngb, "*");
+    mul_core(a, lnga, b, lngb, c);
     trace_nl(c, lnga+lngb);
     return true;
 }
@@ -310,60 +450,106 @@ bool mpn_manager::div_1(mpn_sbuffer & numer, mpn_digit const denom,
     return true; // return rem != 0 or something like that?
 }
 
+// Divide np[0..nn) by dp[0..dn) using Knuth's Algorithm D, where dn > 1 and dp is normalized.
+// Store the nn - dn least significant digits of the quotient in qp, and return its most
+// significant digit (0 or 1). The remainder is left in np[0..dn).
+static mpn_digit div_basecase(mpn_digit * qp, mpn_digit * np, size_t nn, mpn_digit const * dp, size_t dn) {
+    SASSERT(dn > 1 && nn >= dn);
+    size_t qn = nn - dn;
+    mpn_digit qh = 0;
+    if (compare_n(np + qn, dp, dn) >= 0) {
+        sub_in_place(np + qn, dn, dp, dn);
+        qh = 1;
+    }
+    mpn_double_digit d1 = dp[dn-1];
+    mpn_double_digit d0 = dp[dn-2];
+    for (size_t j = qn; j-- > 0; ) {
+        // Replace np[j+dn]...np[j] with np[j+dn]...np[j] - q_hat * (dp[dn-1]...dp[0])
+        mpn_double_digit temp  = (((mpn_double_digit)np[j+dn]) << DIGIT_BITS) | ((mpn_double_digit)np[j+dn-1]);
+        mpn_double_digit q_hat = temp / d1;
+        mpn_double_digit r_hat = temp % d1;
+        while (q_hat >= BASE || 
+               q_hat * d0 > ((r_hat << DIGIT_BITS) | (mpn_double_digit)np[j+dn-2])) {
+            q_hat--;
+            r_hat += d1;
+            if (r_hat >= BASE)
+                break;
+        }
+        SASSERT(q_hat < BASE);
+        mpn_digit borrow = submul_1(np + j, dp, dn, (mpn_digit)q_hat);
+        mpn_digit top    = np[j+dn];
+        np[j+dn] = top - borrow;
+        if (top < borrow) {
+            q_hat--;
+            np[j+dn] += add_n(np + j, np + j, dn, dp, dn);
+        }
+        qp[j] = (mpn_digit)q_hat;
+    }
+    return qh;
+}
+
+// Divide np[0..dn+qn) by dp[0..dn), where qn <= dn and dp is normalized, using the 
+// recursive (divide and conquer) method of Burnikel and Ziegler.
+// Store the qn least significant digits of the quotient in qp, and return its most 
+// significant digit (0 or 1). The remainder is left in np[0..dn).
+// tp is a workspace of dn digits.
+static mpn_digit div_dc(mpn_digit * qp, mpn_digit * np, size_t qn, mpn_digit const * dp, size_t dn, mpn_digit * tp) {
+    SASSERT(qn <= dn);
+    if (qn < DIV_DC_THRESHOLD)
+        return div_basecase(qp, np, dn + qn, dp, dn);
+    if (qn == dn) {
+        size_t lo = qn/2;
+        size_t hi = qn - lo;
+        mpn_digit qh = div_dc(qp + lo, np + lo, hi, dp, dn, tp);
+        mpn_digit ql = div_dc(qp, np, lo, dp, dn, tp);
+        SASSERT(ql == 0);
+        return qh;
+    }
+    // Divide the 2*qn most significant digits by the qn most significant digits of dp,
+    // and then correct the result using the remaining dn - qn digits of dp.
+    mpn_digit qh = div_dc(qp, np + dn - qn, qn, dp + dn - qn, qn, tp);
+    mul_core(qp, qn, dp, dn - qn, tp);
+    mpn_digit cy = sub_in_place(np, dn, tp, dn);
+    if (qh)
+        cy += sub_in_place(np + qn, dn - qn, dp, dn - qn);
+    while (cy) {
+        qh -= dec_in_place(qp, qn);
+        cy -= add_n(np, np, dn, dp, dn);
+    }
+    return qh;
+}
+
 bool mpn_manager::div_n(mpn_sbuffer & numer, mpn_sbuffer const & denom,
                         mpn_digit * quot, mpn_digit * rem) {
     SASSERT(denom.size() > 1);
 
-    // This is essentially Knuth's Algorithm D.
     size_t m = numer.size() - denom.size();
     size_t n = denom.size();
+    mpn_digit * np = numer.c_ptr();
+    mpn_digit const * dp = denom.c_ptr();
 
     SASSERT(numer.size() == m+n);
+    SASSERT(compare_n(np + m, dp, n) < 0);
 
-    t_ms.resize(n+1);
-    
-    mpn_double_digit q_hat, temp, r_hat;
-    mpn_digit borrow;
-
-    for (size_t j = m-1; j != (size_t)-1; j--) {
-        temp = (((mpn_double_digit)numer[j+n]) << DIGIT_BITS) | ((mpn_double_digit)numer[j+n-1]);
-        q_hat = temp / (mpn_double_digit) denom[n-1];
-        r_hat = temp % (mpn_double_digit) denom[n-1];
-        recheck:
-        if (q_hat >= BASE || 
-            ((q_hat * denom[n-2]) > ((r_hat << DIGIT_BITS) + numer[j+n-2]))) {
-                q_hat--;
-                r_hat += denom[n-1];
-                if (r_hat < BASE) goto recheck;
-        }
-        SASSERT(q_hat < BASE);        
-        // Replace numer[j+n]...numer[j] with 
-        // numer[j+n]...numer[j] - q * (denom[n-1]...denom[0])
-        mpn_digit q_hat_small = (mpn_digit)q_hat;
-        #ifdef Z3DEBUG
-        trace_enabled = false;
-        #endif
-        mul(&q_hat_small, 1, denom.c_ptr(), n, t_ms.c_ptr());
-        sub(&numer[j], n+1, t_ms.c_ptr(), n+1, &numer[j], &borrow);
-        quot[j] = q_hat_small;
-        if (borrow) {
-            quot[j]--;
-            t_ab.resize(n+2);
-            size_t real_size;
-            add(denom.c_ptr(), n, &numer[j], n+1, t_ab.c_ptr(), n+2, &real_size);
-            for (size_t i = 0; i < n+1; i++)
-                numer[j+i] = t_ab[i];
+    if (n < DIV_DC_THRESHOLD || m < DIV_DC_THRESHOLD) {
+        VERIFY(div_basecase(quot, np, m+n, dp, n) == 0);
+    }
+    else {
+        // Compute the quotient in blocks of (at most) n digits, starting with the most significant one.
+        sbuffer<mpn_digit> tp(static_cast<unsigned>(n), 0);
+        size_t b = m % n == 0 ? n : m % n;
+        size_t j = m - b;
+        VERIFY(div_dc(quot + j, np + j, b, dp, n, tp.c_ptr()) == 0);
+        while (j > 0) {
+            j -= n;
+            VERIFY(div_dc(quot + j, np + j, n, dp, n, tp.c_ptr()) == 0);
         }
-        #ifdef Z3DEBUG
-        trace_enabled = true;
-        #endif
-        STRACE("mpn_div", tout << "q_hat=" << q_hat << " r_hat=" << r_hat;
-                          tout << " t_ms="; display_raw(tout, t_ms.c_ptr(), n);
-                          tout << " new numer="; display_raw(tout, numer.c_ptr(), m+n+1);
-                          tout << " borrow=" << borrow;
-                          tout << std::endl; );
     }
 
+    STRACE("mpn_div", tout << "quot="; display_raw(tout, quot, m);
+                      tout << " new numer="; display_raw(tout, np, m+n);
+                      tout << std::endl; );
+
     return true; // return rem != 0 or something like that?
 }
 
@@ -84,7 +84,7 @@ private:
     #endif
 
     static const mpn_digit zero;
-    mpn_sbuffer u, v, t_ms, t_ab;
+    mpn_sbuffer u, v;
     void display_raw(std::ostream & out, mpn_digit const * a, size_t const lng) const;
 
     size_t div_normalize(mpn_digit const * numer, size_t const lnum,
@@ -121,8 +121,6 @@ public:
     void finalize() {
         u.finalize();
         v.finalize();
-        t_ms.finalize();
-        t_ab.finalize();
     }
 };
 
@@ -101,7 +101,6 @@ mpz_manager<SYNCH>::mpz_manager():
         m_arg[i] = allocate(m_init_cell_capacity);
         m_arg[i]->m_size = 1;
     }
-    set(m_int_min, -static_cast<int64>(INT_MIN));
 #else
     // GMP
     mpz_init(m_tmp);
@@ -142,7 +141,6 @@ template<bool SYNCH>
 mpz_manager<SYNCH>::~mpz_manager() {
     del(m_two64);
 #ifndef _MP_GMP
-    del(m_int_min);
     for (unsigned i = 0; i < 2; i++) {
         deallocate(m_tmp[i]);
         deallocate(m_arg[i]);
@@ -170,46 +168,47 @@ void mpz_manager<SYNCH>::set_big_i64(mpz & c, int64 v) {
     SASSERT(capacity(c) >= m_init_cell_capacity);
     uint64 _v;
     if (v < 0) {
-        _v = -v;
+        _v = -static_cast<uint64>(v);
         c.m_val = -1;
     }
     else {
         _v = v;
         c.m_val = 1;
     }
-    if (sizeof(digit_t) == sizeof(uint64)) {
-        // 64-bit machine
-        digits(c)[0] = static_cast<digit_t>(_v);
-        c.m_ptr->m_size = 1;
-    }
-    else {
-        // 32-bit machine
-        digits(c)[0] = static_cast<unsigned>(_v);
-        digits(c)[1] = static_cast<unsigned>(_v >> 32);
-        c.m_ptr->m_size = digits(c)[1] == 0 ? 1 : 2;
-    }
+    set_abs_digits(c.m_ptr, _v);
 #else
     if (is_small(c)) {
         c.m_ptr = allocate();
     }
+    set_mpz_t(*c.m_ptr, v);
+#endif
+}
+
+#ifdef _MP_GMP
+template<bool SYNCH>
+void mpz_manager<SYNCH>::set_mpz_t(mpz_t & r, int64 v) {
+    if (sizeof(long) >= sizeof(int64) || (INT_MIN <= v && v <= INT_MAX)) {
+        mpz_set_si(r, static_cast<long>(v));
+        return;
+    }
     uint64 _v;
     bool sign;
     if (v < 0) {
-        _v   = -v;
+        _v   = -static_cast<uint64>(v);
         sign = true;
     }
     else {
         _v   = v;
         sign = false;
     }
-    mpz_set_ui(*c.m_ptr, static_cast<unsigned>(_v));
-    mpz_set_ui(m_tmp,    static_cast<unsigned>(_v >> 32));
+    mpz_set_ui(r,     static_cast<unsigned>(_v));
+    mpz_set_ui(m_tmp, static_cast<unsigned>(_v >> 32));
     mpz_mul(m_tmp, m_tmp, m_two32);
-    mpz_add(*c.m_ptr, *c.m_ptr, m_tmp);
+    mpz_add(r, r, m_tmp);
     if (sign)
-        mpz_neg(*c.m_ptr, *c.m_ptr);
-#endif
+        mpz_neg(r, r);
 }
+#endif
 
 template<bool SYNCH>
 void mpz_manager<SYNCH>::set_big_ui64(mpz & c, uint64 v) {
@@ -219,17 +218,7 @@ void mpz_manager<SYNCH>::set_big_ui64(mpz & c, uint64 v) {
     }
     SASSERT(capacity(c) >= m_init_cell_capacity);
     c.m_val = 1;
-    if (sizeof(digit_t) == sizeof(uint64)) {
-        // 64-bit machine
-        digits(c)[0] = static_cast<digit_t>(v);
-        c.m_ptr->m_size = 1;
-    }
-    else {
-        // 32-bit machine
-        digits(c)[0] = static_cast<unsigned>(v);
-        digits(c)[1] = static_cast<unsigned>(v >> 32);
-        c.m_ptr->m_size = digits(c)[1] == 0 ? 1 : 2;
-    }
+    set_abs_digits(c.m_ptr, v);
 #else
     if (is_small(c)) {
         c.m_ptr = allocate();
@@ -264,10 +253,11 @@ void mpz_manager<SYNCH>::set(mpz & a, int sign, unsigned sz) {
         return;
     }
     
-    if (i == 1 && m_tmp[IDX]->m_digits[0] <= INT_MAX) {
+    int64 val;
+    if (digits_to_small(sign, i, m_tmp[IDX]->m_digits, val)) {
         // m_tmp[IDX] fits is a fixnum
         del(a);
-        a.m_val = sign < 0 ? -static_cast<int>(m_tmp[IDX]->m_digits[0]) : static_cast<int>(m_tmp[IDX]->m_digits[0]);
+        a.m_val = val;
         return;
     }
 
@@ -307,10 +297,11 @@ void mpz_manager<SYNCH>::set(mpz & target, unsigned sz, digit_t const * digits)
     // remove zero digits
     while (sz > 0 && digits[sz - 1] == 0)
         sz--;
+    int64 val;
     if (sz == 0)
         reset(target);
-    else if (sz == 1)
-        set(target, digits[0]);
+    else if (digits_to_small(1, sz, digits, val))
+        set_i64(target, val);
     else {
 #ifndef _MP_GMP
         target.m_val = 1; // number is positive.
@@ -573,14 +564,14 @@ void mpz_manager<SYNCH>::big_rem(mpz const & a, mpz const & b, mpz & c) {
 template<bool SYNCH>
 void mpz_manager<SYNCH>::gcd(mpz const & a, mpz const & b, mpz & c) {
     if (is_small(a) && is_small(b)) {
-        int _a = a.m_val;
-        int _b = b.m_val;
+        int64 _a = a.m_val;
+        int64 _b = b.m_val;
         if (_a < 0) _a = -_a;
         if (_b < 0) _b = -_b;
-        unsigned r = u_gcd(_a, _b);
-        // Remark: r is (INT_MAX + 1)
-        // If a == b == INT_MIN
-        set(c, r);
+        if (_a <= UINT_MAX && _b <= UINT_MAX)
+            set(c, u_gcd(static_cast<unsigned>(_a), static_cast<unsigned>(_b)));
+        else
+            set(c, u64_gcd(_a, _b));
     }
     else {
 #ifdef _MP_GMP
@@ -753,7 +744,7 @@ void mpz_manager<SYNCH>::gcd(mpz const & a, mpz const & b, mpz & c) {
             SASSERT(ge(a1, b1));
             if (is_small(b1)) {
                 if (is_small(a1)) {
-                    unsigned r = u_gcd(a1.m_val, b1.m_val);
+                    uint64 r = u64_gcd(a1.m_val, b1.m_val);
                     set(c, r);
                     break;
                 }
@@ -1456,8 +1447,17 @@ std::string mpz_manager<SYNCH>::to_string(mpz const & a) const {
 
 template<bool SYNCH>
 unsigned mpz_manager<SYNCH>::hash(mpz const & a) {
-    if (is_small(a))
-        return a.m_val;
+    if (is_small(a)) {
+        // keep the hash code a number would have as a cell with 32-bit digits
+        int64 v = a.m_val;
+        if (INT_MIN <= v && v <= INT_MAX)
+            return static_cast<unsigned>(v);
+        uint64 u = v < 0 ? -static_cast<uint64>(v) : static_cast<uint64>(v);
+        if (u <= UINT_MAX)
+            return static_cast<unsigned>(u);
+        unsigned ds[2] = { static_cast<unsigned>(u), static_cast<unsigned>(u >> 32) };
+        return string_hash(reinterpret_cast<char*>(ds), sizeof(ds), 17);
+    }
 #ifndef _MP_GMP
     unsigned sz = size(a);
     if (sz == 1)
@@ -1480,9 +1480,9 @@ void mpz_manager<SYNCH>::power(mpz const & a, unsigned p, mpz & b) {
 #ifndef _MP_GMP
     if (is_small(a)) {
         if (a.m_val == 2) {
-            if (p < 8 * sizeof(int) - 1) {
+            if (p < 8 * sizeof(int64) - 1) {
                 del(b);
-                b.m_val = 1 << p;
+                b.m_val = static_cast<int64>(1) << p;
             }
             else {
                 unsigned sz    = p/(8 * sizeof(digit_t)) + 1;
@@ -1534,8 +1534,9 @@ bool mpz_manager<SYNCH>::is_power_of_two(mpz const & a, unsigned & shift) {
     if (is_nonpos(a))
         return false;
     if (is_small(a)) {
-        if (::is_power_of_two(a.m_val)) {
-            shift = ::log2(a.m_val);
+        uint64 v = a.m_val;
+        if (!(v & (v - 1))) {
+            shift = uint64_log2(v);
             return true;
         }
         else {
@@ -1580,22 +1581,13 @@ void mpz_manager<SYNCH>::ensure_capacity(mpz & a, unsigned capacity) {
     if (is_small(a)) {
         a.m_ptr = allocate(capacity);
         SASSERT(a.m_ptr->m_capacity == capacity);
-        if (a.m_val == INT_MIN) {
-            unsigned intmin_sz = m_int_min.m_ptr->m_size;
-            for (unsigned i = 0; i < intmin_sz; i++)
-                a.m_ptr->m_digits[i] = m_int_min.m_ptr->m_digits[i];
-            a.m_val = -1;
-            a.m_ptr->m_size = m_int_min.m_ptr->m_size;
-        }
-        else if (a.m_val < 0) {
-            a.m_ptr->m_digits[0] = -a.m_val;
+        if (a.m_val < 0) {
+            set_abs_digits(a.m_ptr, -a.m_val);
             a.m_val = -1;
-            a.m_ptr->m_size = 1;
         }
         else {
-            a.m_ptr->m_digits[0] =  a.m_val;
+            set_abs_digits(a.m_ptr, a.m_val);
             a.m_val = 1;
-            a.m_ptr->m_size = 1;
         }
     }
     else {
@@ -1628,9 +1620,9 @@ void mpz_manager<SYNCH>::normalize(mpz & a) {
         return;
     }
     
-    if (i == 1 && ds[0] <= INT_MAX) {
+    int64 val;
+    if (digits_to_small(static_cast<int>(a.m_val), i, ds, val)) {
         // a is small
-        int val = a.m_val < 0 ? -static_cast<int>(ds[0]) : static_cast<int>(ds[0]);
         del(a);
         a.m_val = val;
         return;
@@ -1645,8 +1637,8 @@ void mpz_manager<SYNCH>::machine_div2k(mpz & a, unsigned k) {
     if (k == 0 || is_zero(a))
         return;
     if (is_small(a)) {
-        if (k < 32) {
-            int twok = 1 << k;
+        if (k < 63) {
+            int64 twok = static_cast<int64>(1) << k;
             a.m_val /= twok;
         }
         else {
@@ -1714,15 +1706,18 @@ template<bool SYNCH>
 void mpz_manager<SYNCH>::mul2k(mpz & a, unsigned k) {
     if (k == 0 || is_zero(a))
         return;
-    if (is_small(a) && k < 32) {
-        set_i64(a, i64(a) * (static_cast<int64>(1) << k));
-        return;
+    if (is_small(a) && k < 63) {
+        uint64 v = a.m_val < 0 ? -a.m_val : a.m_val;
+        if (uint64_log2(v) + k < 63) {
+            a.m_val *= static_cast<int64>(1) << k;
+            return;
+        }
     }
 #ifndef _MP_GMP
     TRACE("mpz_mul2k", tout << "mul2k\na: " << to_string(a) << "\nk: " << k << "\n";);
     unsigned word_shift  = k / (8 * sizeof(digit_t));
     unsigned bit_shift   = k % (8 * sizeof(digit_t));
-    unsigned old_sz      = is_small(a) ? 1 : a.m_ptr->m_size;
+    unsigned old_sz      = is_small(a) ? 2 : a.m_ptr->m_size;
     unsigned new_sz      = old_sz + word_shift + 1;
     ensure_capacity(a, new_sz);
     TRACE("mpz_mul2k", tout << "word_shift: " << word_shift << "\nbit_shift: " << bit_shift << "\nold_sz: " << old_sz << "\nnew_sz: " << new_sz 
@@ -1782,7 +1777,11 @@ unsigned mpz_manager<SYNCH>::power_of_two_multiple(mpz const & a) {
         return 0;
     if (is_small(a)) {
         unsigned r = 0;
-        int v      = a.m_val;
+        int64 v    = a.m_val;
+        if (v % (static_cast<int64>(1) << 32) == 0) {
+            r += 32;
+            v /= (static_cast<int64>(1) << 32);
+        }
 #define COUNT_DIGIT_RIGHT_ZEROS()               \
         if (v % (1 << 16) == 0) {               \
             r += 16;                            \
@@ -1838,7 +1837,7 @@ unsigned mpz_manager<SYNCH>::log2(mpz const & a) {
     if (is_nonpos(a))
         return 0;
     if (is_small(a))
-        return ::log2(a.m_val);
+        return uint64_log2(a.m_val);
 #ifndef _MP_GMP
     COMPILE_TIME_ASSERT(sizeof(digit_t) == 8 || sizeof(digit_t) == 4);
     mpz_cell * c     = a.m_ptr;
@@ -1860,7 +1859,7 @@ unsigned mpz_manager<SYNCH>::mlog2(mpz const & a) {
     if (is_nonneg(a))
         return 0;
     if (is_small(a))
-        return ::log2(-a.m_val);
+        return uint64_log2(-a.m_val);
 #ifndef _MP_GMP
     COMPILE_TIME_ASSERT(sizeof(digit_t) == 8 || sizeof(digit_t) == 4);
     mpz_cell * c     = a.m_ptr;
@@ -2037,14 +2036,11 @@ template<bool SYNCH>
 bool mpz_manager<SYNCH>::decompose(mpz const & a, svector<digit_t> & digits) {
     digits.reset();
     if (is_small(a)) {
-        if (a.m_val < 0) {
-            digits.push_back(-a.m_val);
-            return true;
-        }
-        else {
-            digits.push_back(a.m_val);
-            return false;
-        }
+        uint64 v = a.m_val < 0 ? -a.m_val : a.m_val;
+        digits.push_back(static_cast<digit_t>(v));
+        if (sizeof(digit_t) < sizeof(uint64) && (v >> 32) != 0)
+            digits.push_back(static_cast<digit_t>(v >> 32));
+        return a.m_val < 0;
     }
     else {
 #ifndef _MP_GMP
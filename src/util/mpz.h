@@ -37,6 +37,7 @@ typedef unsigned digit_t;
 
 #ifdef _MSC_VER
 #pragma warning(disable : 4200)
+#include<intrin.h>
 #endif 
 
 template<bool SYNCH> class mpz_manager;
@@ -72,11 +73,13 @@ class mpz_cell {
    \brief Multi-precision integer.
    
    If m_ptr == 0, the it is a small number and the value is stored at m_val.
+   Small numbers range over [-INT64_MAX, INT64_MAX]. INT64_MIN is never small,
+   so negation and absolute value of small numbers never overflow.
    Otherwise, m_val contains the sign (-1 negative, 1 positive), and m_ptr points to a mpz_cell that
    store the value. <<< This last statement is true only in Windows.
 */
 class mpz {
-    int        m_val; 
+    int64      m_val; 
 #ifndef _MP_GMP
     mpz_cell * m_ptr;
 #else
@@ -112,7 +115,6 @@ class mpz_manager {
     unsigned                m_init_cell_capacity;
     mpz_cell *              m_tmp[2];
     mpz_cell *              m_arg[2];
-    mpz                     m_int_min;
     
     static unsigned cell_size(unsigned capacity) { return sizeof(mpz_cell) + sizeof(digit_t) * capacity; }
 
@@ -187,14 +189,72 @@ class mpz_manager {
     template<int IDX>
     void set(mpz & a, int sign, unsigned sz);
 
-    static int64 i64(mpz const & a) { return static_cast<int64>(a.m_val); }
+    static int64 i64(mpz const & a) { return a.m_val; }
+
+    /**
+       \brief Overflow checked operations on the values of small numbers.
+       Return true if the result does not fit in a small number.
+    */
+    static bool add_overflow(int64 a, int64 b, int64 & r) {
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+        return __builtin_add_overflow(a, b, &r) || r == INT64_MIN;
+#else
+        r = static_cast<int64>(static_cast<uint64>(a) + static_cast<uint64>(b));
+        return ((a ^ r) & (b ^ r)) < 0 || r == INT64_MIN;
+#endif
+    }
+
+    static bool sub_overflow(int64 a, int64 b, int64 & r) {
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+        return __builtin_sub_overflow(a, b, &r) || r == INT64_MIN;
+#else
+        r = static_cast<int64>(static_cast<uint64>(a) - static_cast<uint64>(b));
+        return ((a ^ b) & (a ^ r)) < 0 || r == INT64_MIN;
+#endif
+    }
+
+    static bool mul_overflow(int64 a, int64 b, int64 & r) {
+#if defined(__SIZEOF_INT128__)
+        __int128 p = static_cast<__int128>(a) * static_cast<__int128>(b);
+        r = static_cast<int64>(p);
+        return p > INT64_MAX || p < -INT64_MAX;
+#elif defined(_MSC_VER) && defined(_M_X64)
+        int64 hi;
+        r = _mul128(a, b, &hi);
+        return hi != (r < 0 ? -1 : 0) || r == INT64_MIN;
+#else
+        if (INT_MIN < a && a <= INT_MAX && INT_MIN < b && b <= INT_MAX) {
+            r = a * b;
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    /**
+       \brief Return true if the number with sign \c sign and digits \c ds[0], ..., \c ds[sz-1]
+       fits in a small number, and store its value in \c r.
+    */
+    static bool digits_to_small(int sign, unsigned sz, digit_t const * ds, int64 & r) {
+        uint64 v;
+        if (sz == 1)
+            v = ds[0];
+        else if (sz == 2 && sizeof(digit_t) < sizeof(uint64))
+            v = (static_cast<uint64>(ds[1]) << 32) | static_cast<uint64>(ds[0]);
+        else
+            return false;
+        if (v > static_cast<uint64>(INT64_MAX))
+            return false;
+        r = sign < 0 ? -static_cast<int64>(v) : static_cast<int64>(v);
+        return true;
+    }
 
     void set_big_i64(mpz & c, int64 v);
 
     void set_i64(mpz & c, int64 v) { 
-        if (v >= INT_MIN && v <= INT_MAX) {
+        if (v != INT64_MIN) {
             del(c);
-            c.m_val = static_cast<int>(v); 
+            c.m_val = v; 
         }
         else {
             MPZ_BEGIN_CRITICAL();
@@ -236,39 +296,50 @@ class mpz_manager {
             return ((static_cast<uint64>(digits(a)[1]) << 32) | (static_cast<uint64>(digits(a)[0])));
     }
 
+    // Store the absolute value v in the digits of the given cell.
+    static void set_abs_digits(mpz_cell * cell, uint64 v) {
+        if (sizeof(digit_t) == sizeof(uint64)) {
+            // 64-bit machine
+            cell->m_digits[0] = static_cast<digit_t>(v);
+            cell->m_size      = 1;
+        }
+        else {
+            // 32-bit machine
+            cell->m_digits[0] = static_cast<digit_t>(v);
+            cell->m_digits[1] = static_cast<digit_t>(v >> 32);
+            cell->m_size      = cell->m_digits[1] == 0 ? 1 : 2;
+        }
+    }
+
     template<int IDX>
     void get_sign_cell(mpz const & a, int & sign, mpz_cell * & cell) {
         if (is_small(a)) {
-            if (a.m_val == INT_MIN) {
+            cell = m_arg[IDX];
+            if (a.m_val < 0) {
                 sign = -1;
-                cell = m_int_min.m_ptr;
+                set_abs_digits(cell, static_cast<uint64>(-a.m_val));
             }
             else {
-                cell = m_arg[IDX];
-                SASSERT(cell->m_size == 1);
-                if (a.m_val < 0) {
-                    sign = -1;
-                    cell->m_digits[0] = -a.m_val;
-                }
-                else {
-                    sign = 1;
-                    cell->m_digits[0] = a.m_val;
-                }
+                sign = 1;
+                set_abs_digits(cell, static_cast<uint64>(a.m_val));
             }
         }
         else {
-            sign = a.m_val;
+            sign = static_cast<int>(a.m_val);
             cell = a.m_ptr;
         }
     }
 #else
     // GMP code
 
+    // Store v in the GMP number r.
+    void set_mpz_t(mpz_t & r, int64 v);
+
     template<int IDX>
     void get_arg(mpz const & a, mpz_t * & result) {
         if (is_small(a)) {
             result = m_arg[IDX];
-            mpz_set_si(*result, a.m_val);
+            set_mpz_t(*result, a.m_val);
         }
         else {
             result = a.m_ptr;
@@ -343,8 +414,10 @@ public:
     
     void add(mpz const & a, mpz const & b, mpz & c) {
         STRACE("mpz", tout << "[mpz] " << to_string(a) << " + " << to_string(b) << " == ";); 
-        if (is_small(a) && is_small(b)) {
-            set_i64(c, i64(a) + i64(b));
+        int64 r;
+        if (is_small(a) && is_small(b) && !add_overflow(i64(a), i64(b), r)) {
+            del(c);
+            c.m_val = r;
         }
         else {
             MPZ_BEGIN_CRITICAL();
@@ -356,8 +429,10 @@ public:
 
     void sub(mpz const & a, mpz const & b, mpz & c) {
         STRACE("mpz", tout << "[mpz] " << to_string(a) << " - " << to_string(b) << " == ";); 
-        if (is_small(a) && is_small(b)) {
-            set_i64(c, i64(a) - i64(b));
+        int64 r;
+        if (is_small(a) && is_small(b) && !sub_overflow(i64(a), i64(b), r)) {
+            del(c);
+            c.m_val = r;
         }
         else {
             MPZ_BEGIN_CRITICAL();
@@ -373,8 +448,10 @@ public:
 
     void mul(mpz const & a, mpz const & b, mpz & c) {
         STRACE("mpz", tout << "[mpz] " << to_string(a) << " * " << to_string(b) << " == ";); 
-        if (is_small(a) && is_small(b)) {
-            set_i64(c, i64(a) * i64(b));
+        int64 r;
+        if (is_small(a) && is_small(b) && !mul_overflow(i64(a), i64(b), r)) {
+            del(c);
+            c.m_val = r;
         }
         else {
             MPZ_BEGIN_CRITICAL();
@@ -493,11 +570,6 @@ public:
 
     void neg(mpz & a) {
         STRACE("mpz", tout << "[mpz] 0 - " << to_string(a) << " == ";); 
-        if (is_small(a) && a.m_val == INT_MIN) {
-            // neg(INT_MIN) is not a small int
-            set_big_i64(a, - static_cast<long long>(INT_MIN)); 
-            return;
-        }
 #ifndef _MP_GMP
         a.m_val = -a.m_val;
 #else
@@ -513,14 +585,8 @@ public:
 
     void abs(mpz & a) {
         if (is_small(a)) {
-            if (a.m_val < 0) {
-                if (a.m_val == INT_MIN) {
-                    // abs(INT_MIN) is not a small int
-                    set_big_i64(a, - static_cast<long long>(INT_MIN)); 
-                }
-                else
-                    a.m_val = -a.m_val;
-            }
+            if (a.m_val < 0) 
+                a.m_val = -a.m_val;
         }
         else {
 #ifndef _MP_GMP
@@ -566,10 +632,10 @@ public:
 
     static int sign(mpz const & a) {
 #ifndef _MP_GMP
-        return a.m_val;
+        return a.m_val < 0 ? -1 : (a.m_val > 0 ? 1 : 0);
 #else
         if (is_small(a))
-            return a.m_val;
+            return a.m_val < 0 ? -1 : (a.m_val > 0 ? 1 : 0);
         else
             return mpz_sgn(*a.m_ptr);
 #endif
@@ -659,10 +725,8 @@ public:
     }
 
     void set(mpz & a, unsigned val) {
-        if (val <= INT_MAX)
-            set(a, static_cast<int>(val));
-        else
-            set(a, static_cast<int64>(static_cast<uint64>(val)));
+        del(a);
+        a.m_val = val;
     }
 
     void set(mpz & a, char const * val);
@@ -672,9 +736,9 @@ public:
     }
 
     void set(mpz & a, uint64 val) {
-        if (val < INT_MAX) {
+        if (val <= static_cast<uint64>(INT64_MAX)) {
             del(a);
-            a.m_val = static_cast<int>(val);
+            a.m_val = static_cast<int64>(val);
         }
         else {
             MPZ_BEGIN_CRITICAL();
@@ -25,10 +25,16 @@ Revision History:
 #include"vector.h"
 #include<iomanip>
 
+// Minimal number of free objects (in chunks) in a slot before it is consolidated.
+#define MIN_RELEASE_CHUNKS 4
+
 small_object_allocator::small_object_allocator(char const * id) {
     for (unsigned i = 0; i < NUM_SLOTS; i++) {
         m_chunks[i] = 0;
         m_free_list[i] = 0;
+        m_num_chunks[i] = 0;
+        m_num_free[i] = 0;
+        m_release_threshold[i] = i == 0 ? UINT_MAX : MIN_RELEASE_CHUNKS * get_num_objs_per_chunk(i);
     }
     DEBUG_CODE({
         m_id = id;
@@ -62,6 +68,9 @@ void small_object_allocator::reset() {
         }
         m_chunks[i] = 0;
         m_free_list[i] = 0;
+        m_num_chunks[i] = 0;
+        m_num_free[i] = 0;
+        m_release_threshold[i] = i == 0 ? UINT_MAX : MIN_RELEASE_CHUNKS * get_num_objs_per_chunk(i);
     }
     m_alloc_size = 0;
 }
@@ -88,6 +97,9 @@ void small_object_allocator::deallocate(size_t size, void * p) {
     SASSERT(slot_id < NUM_SLOTS);
     *(reinterpret_cast<void**>(p)) = m_free_list[slot_id];
     m_free_list[slot_id] = p;
+    m_num_free[slot_id]++;
+    if (m_num_free[slot_id] >= m_release_threshold[slot_id])
+        consolidate(slot_id);
 }
 
 void * small_object_allocator::allocate(size_t size) {
@@ -109,6 +121,8 @@ void * small_object_allocator::allocate(size_t size) {
     if (m_free_list[slot_id] != 0) {
         void * r = m_free_list[slot_id];
         m_free_list[slot_id] = *(reinterpret_cast<void **>(r));
+        SASSERT(m_num_free[slot_id] > 0);
+        m_num_free[slot_id]--;
         return r;
     }
     chunk * c = m_chunks[slot_id]; 
@@ -125,6 +139,7 @@ void * small_object_allocator::allocate(size_t size) {
     chunk * new_c = alloc(chunk);
     new_c->m_next = c;
     m_chunks[slot_id] = new_c;
+    m_num_chunks[slot_id]++;
     void * r = new_c->m_curr;
     new_c->m_curr += size;
     return r;
@@ -134,11 +149,7 @@ size_t small_object_allocator::get_wasted_size() const {
     size_t r = 0;
     for (unsigned slot_id = 0; slot_id < NUM_SLOTS; slot_id++) {
         size_t slot_obj_size = slot_id << PTR_ALIGNMENT;
-        void ** ptr = reinterpret_cast<void **>(const_cast<small_object_allocator*>(this)->m_free_list[slot_id]);
-        while (ptr != 0) {
-            r += slot_obj_size;
-            ptr = reinterpret_cast<void**>(*ptr);
-        }
+        r += slot_obj_size * m_num_free[slot_id];
     }
     return r;
 }
@@ -146,15 +157,21 @@ size_t small_object_allocator::get_wasted_size() const {
 size_t small_object_allocator::get_num_free_objs() const {
     size_t r = 0;
     for (unsigned slot_id = 0; slot_id < NUM_SLOTS; slot_id++) {
-        void ** ptr = reinterpret_cast<void **>(const_cast<small_object_allocator*>(this)->m_free_list[slot_id]);
-        while (ptr != 0) {
-            r ++;
-            ptr = reinterpret_cast<void**>(*ptr);
-        }
+        r += m_num_free[slot_id];
     }
     return r;
 }
 
+void small_object_allocator::display_statistics(std::ostream & out) const {
+    for (unsigned slot_id = 1; slot_id < NUM_SLOTS; slot_id++) {
+        if (m_num_chunks[slot_id] == 0)
+            continue;
+        out << "(size-class :size " << (slot_id << PTR_ALIGNMENT) 
+            << " :chunks " << m_num_chunks[slot_id] 
+            << " :free " << m_num_free[slot_id] << ")\n";
+    }
+}
+
 template<typename T>
 struct ptr_lt {
     bool operator()(T * p1, T * p2) const { return p1 < p2; }
@@ -167,69 +184,96 @@ void small_object_allocator::consolidate() {
                verbose_stream() << "(allocator-consolidate :wasted-size " << get_wasted_size()
                << " :memory " << std::fixed << std::setprecision(2) << 
                static_cast<double>(memory::get_allocation_size())/static_cast<double>(1024*1024) << ")" << std::endl;);
-    ptr_vector<chunk> chunks;
-    ptr_vector<char> free_objs;
     for (unsigned slot_id = 1; slot_id < NUM_SLOTS; slot_id++) {
         if (m_free_list[slot_id] == 0)
             continue;
-        chunks.reset();
-        free_objs.reset();
-        chunk * c = m_chunks[slot_id];
-        while (c != 0) {
-            chunks.push_back(c);
-            c = c->m_next;
-        }
-        char * ptr = static_cast<char*>(m_free_list[slot_id]);
-        while (ptr != 0) {
-            free_objs.push_back(ptr);
-            ptr = *(reinterpret_cast<char**>(ptr));
-        }
-        unsigned obj_size = slot_id << PTR_ALIGNMENT;
-        unsigned num_objs_per_chunk = CHUNK_SIZE / obj_size;
-        if (free_objs.size() < num_objs_per_chunk)
-            continue;
-        SASSERT(!chunks.empty());
-        std::sort(chunks.begin(), chunks.end(), ptr_lt<chunk>());
-        std::sort(free_objs.begin(), free_objs.end(), ptr_lt<char>());
-        chunk *   last_chunk = 0;
-        void * last_free_obj = 0;
-        unsigned chunk_idx = 0;
-        unsigned obj_idx   = 0;
-        unsigned num_chunks = chunks.size();
-        unsigned num_objs   = free_objs.size();
-        while (chunk_idx < num_chunks) {
-            chunk * curr_chunk = chunks[chunk_idx];
-            char *  curr_begin = curr_chunk->m_data;
-            char *  curr_end   = curr_begin + CHUNK_SIZE;
-            unsigned num_free_in_chunk = 0;
-            unsigned saved_obj_idx = obj_idx;
-            while (obj_idx < num_objs) {
-                char * free_obj = free_objs[obj_idx];
-                if (free_obj > curr_end)
-                    break;
-                obj_idx++;
-                num_free_in_chunk++;
-            }
-            if (num_free_in_chunk == num_objs_per_chunk) {
-                dealloc(curr_chunk);
-            }
-            else {
-                curr_chunk->m_next = last_chunk;
-                last_chunk = curr_chunk;
-                for (unsigned i = saved_obj_idx; i < obj_idx; i++) {
-                    // relink objects
-                    void * free_obj = free_objs[i];
-                    *(reinterpret_cast<void**>(free_obj)) = last_free_obj;
-                    last_free_obj = free_obj;
-                }
-            }
-            chunk_idx++;
-        }
-        m_chunks[slot_id]    = last_chunk;
-        m_free_list[slot_id] = last_free_obj;
+        consolidate(slot_id);
     }
     IF_VERBOSE(CONSOLIDATE_VB_LVL, 
                verbose_stream() << "(end-allocator-consolidate :wasted-size " << get_wasted_size() 
                << " :memory " << std::fixed << std::setprecision(2) 
                << static_cast<double>(memory::get_allocation_size())/static_cast<double>(1024*1024) << ")" << std::endl;);
 }
+
+void small_object_allocator::consolidate(unsigned slot_id) {
+    unsigned num_objs_per_chunk = get_num_objs_per_chunk(slot_id);
+    unsigned num_free = m_num_free[slot_id];
+    // the next automatic consolidation happens when the number of free objects doubles.
+    m_release_threshold[slot_id] = std::max(2 * num_free, MIN_RELEASE_CHUNKS * num_objs_per_chunk);
+    if (num_free < num_objs_per_chunk)
+        return;
+    // The first chunk is the one being carved, it is never released.
+    chunk * first = m_chunks[slot_id];
+    SASSERT(first != 0);
+    ptr_vector<chunk> chunks;
+    ptr_vector<char> free_objs;
+    chunk * c = first->m_next;
+    while (c != 0) {
+        chunks.push_back(c);
+        c = c->m_next;
+    }
+    char * ptr = static_cast<char*>(m_free_list[slot_id]);
+    while (ptr != 0) {
+        free_objs.push_back(ptr);
+        ptr = *(reinterpret_cast<char**>(ptr));
+    }
+    SASSERT(free_objs.size() == num_free);
+    std::sort(chunks.begin(), chunks.end(), ptr_lt<chunk>());
+    std::sort(free_objs.begin(), free_objs.end(), ptr_lt<char>());
+    chunk *   last_chunk = 0;
+    void * last_free_obj = 0;
+    unsigned chunk_idx = 0;
+    unsigned obj_idx   = 0;
+    unsigned num_chunks = chunks.size();
+    unsigned num_objs   = free_objs.size();
+    char * first_begin  = first->m_data;
+    char * first_end    = first_begin + CHUNK_SIZE;
+    while (chunk_idx < num_chunks || obj_idx < num_objs) {
+        chunk * curr_chunk = chunk_idx < num_chunks ? chunks[chunk_idx] : 0;
+        char * obj = obj_idx < num_objs ? free_objs[obj_idx] : 0;
+        if (obj != 0 && first_begin <= obj && obj < first_end) {
+            // free object in the first chunk
+            *(reinterpret_cast<void**>(obj)) = last_free_obj;
+            last_free_obj = obj;
+            obj_idx++;
+            continue;
+        }
+        if (curr_chunk == 0) {
+            UNREACHABLE();
+            break;
+        }
+        char *  curr_begin = curr_chunk->m_data;
+        char *  curr_end   = curr_begin + CHUNK_SIZE;
+        unsigned saved_obj_idx = obj_idx;
+        unsigned num_free_in_chunk = 0;
+        while (obj_idx < num_objs) {
+            char * free_obj = free_objs[obj_idx];
+            if (free_obj >= curr_end || (first_begin <= free_obj && free_obj < first_end))
+                break;
+            SASSERT(curr_begin <= free_obj);
+            obj_idx++;
+            num_free_in_chunk++;
+        }
+        if (num_free_in_chunk == num_objs_per_chunk) {
+            dealloc(curr_chunk);
+            m_num_chunks[slot_id]--;
+            num_free -= num_free_in_chunk;
+        }
+        else {
+            curr_chunk->m_next = last_chunk;
+            last_chunk = curr_chunk;
+            for (unsigned i = saved_obj_idx; i < obj_idx; i++) {
+                // relink objects
+                void * free_obj = free_objs[i];
+                *(reinterpret_cast<void**>(free_obj)) = last_free_obj;
+                last_free_obj = free_obj;
+            }
+        }
+        chunk_idx++;
+    }
+    first->m_next        = last_chunk;
+    m_chunks[slot_id]    = first;
+    m_free_list[slot_id] = last_free_obj;
+    m_num_free[slot_id]  = num_free;
+    m_release_threshold[slot_id] = std::max(2 * num_free, MIN_RELEASE_CHUNKS * num_objs_per_chunk);
+}
@@ -20,6 +20,7 @@ Revision History:
 #ifndef _SMALL_OBJECT_ALLOCATOR_H_
 #define _SMALL_OBJECT_ALLOCATOR_H_
 
+#include<ostream>
 #include"machine.h"
 #include"debug.h"
 
@@ -35,10 +36,15 @@ class small_object_allocator {
     };
     chunk *     m_chunks[NUM_SLOTS];
     void  *     m_free_list[NUM_SLOTS];
+    unsigned    m_num_chunks[NUM_SLOTS];
+    unsigned    m_num_free[NUM_SLOTS];       // size of m_free_list[i]
+    unsigned    m_release_threshold[NUM_SLOTS]; // consolidate slot i when m_num_free[i] reaches this value
     size_t      m_alloc_size;
 #ifdef Z3DEBUG
     char const * m_id;
 #endif
+    static unsigned get_num_objs_per_chunk(unsigned slot_id) { return CHUNK_SIZE / (slot_id << PTR_ALIGNMENT); }
+    void consolidate(unsigned slot_id);
 public:
     small_object_allocator(char const * id = "unknown");
     ~small_object_allocator();
@@ -48,7 +54,13 @@ public:
     size_t get_allocation_size() const { return m_alloc_size; }
     size_t get_wasted_size() const;
     size_t get_num_free_objs() const;
+    /**
+       \brief Return to the memory manager the chunks that contain only free objects.
+       This is also done automatically for a size class when the number of free objects 
+       in it doubles.
+    */
     void consolidate();
+    void display_statistics(std::ostream & out) const;
 };
 
 inline void * operator new(size_t s, small_object_allocator & r) { return r.allocate(s); }
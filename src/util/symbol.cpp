@@ -17,45 +17,144 @@ Revision History:
 
 --*/
 #include"symbol.h"
-#include"str_hashtable.h"
+#include"hash.h"
 #include"region.h"
+#include"vector.h"
 #include"string_buffer.h"
 #include"z3_omp.h"
+#include"z3_atomic.h"
 
 symbol symbol::m_dummy(TAG(void*, static_cast<void*>(0), 2));
 const symbol symbol::null;
 
 /**
    \brief Symbol table manager. It stores the symbol strings created at runtime.
+
+   The table is split into shards selected by the hash code of the string.
+   Lookups do not take any lock: a slot only changes from 0 to a string that
+   has already been stored, and the slot array of a shard is only replaced by
+   a larger copy after the copy is filled. Inserts take the lock of the shard.
+   Replaced slot arrays are kept until the table is destroyed, since lookups
+   in other threads may still be reading them.
 */
 class internal_symbol_table {
-    region        m_region; //!< Region used to store symbol strings.
-    str_hashtable m_table;  //!< Table of created symbol strings.
+    static const unsigned c_num_shards    = 32;
+    static const unsigned c_init_capacity = 64;
+
+    struct slots {
+        unsigned              m_capacity; //!< Power of two.
+        char const * volatile m_data[0];
+    };
+
+    struct shard {
+        slots * volatile m_slots;
+        unsigned         m_size;
+        region           m_region;     //!< Region used to store symbol strings.
+        ptr_vector<slots> m_old_slots; //!< Replaced slot arrays.
+        omp_lock_t       m_lock;
+    };
+
+    shard m_shards[c_num_shards];
+
+    static slots * alloc_slots(unsigned capacity) {
+        slots * r = static_cast<slots*>(memory::allocate(sizeof(slots) + capacity * sizeof(char const *)));
+        r->m_capacity = capacity;
+        for (unsigned i = 0; i < capacity; i++)
+            r->m_data[i] = 0;
+        return r;
+    }
+
+    static unsigned get_hash(char const * s) {
+        return static_cast<unsigned>(reinterpret_cast<size_t const *>(s)[-1]);
+    }
+
+    static unsigned get_shard(unsigned h) { return h % c_num_shards; }
+
+    static unsigned get_idx(unsigned h, slots const * t) { return (h / c_num_shards) & (t->m_capacity - 1); }
+
+    /**
+       \brief Return the position of \c d in \c t, or the position of the empty slot where it should be inserted.
+    */
+    static unsigned find(slots const * t, char const * d, unsigned h) {
+        unsigned mask = t->m_capacity - 1;
+        unsigned idx  = get_idx(h, t);
+        while (true) {
+            char const * c = t->m_data[idx];
+            if (c == 0 || (get_hash(c) == h && strcmp(c, d) == 0))
+                return idx;
+            idx = (idx + 1) & mask;
+        }
+    }
+
+    void expand(shard & s) {
+        slots * t     = s.m_slots;
+        slots * new_t = alloc_slots(2 * t->m_capacity);
+        for (unsigned i = 0; i < t->m_capacity; i++) {
+            char const * c = t->m_data[i];
+            if (c != 0) {
+                unsigned mask = new_t->m_capacity - 1;
+                unsigned idx  = get_idx(get_hash(c), new_t);
+                while (new_t->m_data[idx] != 0)
+                    idx = (idx + 1) & mask;
+                new_t->m_data[idx] = c;
+            }
+        }
+        // the new array must be filled before it is visible to lookups.
+        atomic_fence();
+        s.m_slots = new_t;
+        s.m_old_slots.push_back(t);
+    }
+
 public:
+    internal_symbol_table() {
+        for (unsigned i = 0; i < c_num_shards; i++) {
+            m_shards[i].m_slots = alloc_slots(c_init_capacity);
+            m_shards[i].m_size  = 0;
+            omp_init_lock(&m_shards[i].m_lock);
+        }
+    }
+
+    ~internal_symbol_table() {
+        for (unsigned i = 0; i < c_num_shards; i++) {
+            shard & s = m_shards[i];
+            memory::deallocate(s.m_slots);
+            for (unsigned j = 0; j < s.m_old_slots.size(); j++)
+                memory::deallocate(s.m_old_slots[j]);
+            omp_destroy_lock(&s.m_lock);
+        }
+    }
 
     char const * get_str(char const * d) {
-        char * result;
-        #pragma omp critical (cr_symbol) 
-        {
-        char * r_d = const_cast<char *>(d);
-        str_hashtable::entry * e;
-        if (m_table.insert_if_not_there_core(r_d, e)) {
+        size_t   l = strlen(d);
+        unsigned h = string_hash(d, static_cast<unsigned>(l), 17);
+        shard & s  = m_shards[get_shard(h)];
+        slots * t  = s.m_slots;
+        char const * result = t->m_data[find(t, d, h)];
+        if (result != 0)
+            return result;
+        omp_set_lock(&s.m_lock);
+        // the slots may have been updated by other threads.
+        t = s.m_slots;
+        unsigned idx = find(t, d, h);
+        result = t->m_data[idx];
+        if (result == 0) {
             // new entry
-            size_t l   = strlen(d);
             // store the hash-code before the string
-            size_t * mem = static_cast<size_t*>(m_region.allocate(l + 1 + sizeof(size_t)));
-            *mem = e->get_hash();
+            size_t * mem = static_cast<size_t*>(s.m_region.allocate(l + 1 + sizeof(size_t)));
+            *mem = h;
             mem++;
-            result = reinterpret_cast<char*>(mem);
-            memcpy(result, d, l+1);
-            // update the entry with the new ptr.
-            e->set_data(result);
-        }
-        else {
-            result = e->get_data();
-        }
-        SASSERT(m_table.contains(result));
+            char * r = reinterpret_cast<char*>(mem);
+            memcpy(r, d, l+1);
+            result = r;
+            // the string must be stored before it is visible to lookups.
+            atomic_fence();
+            t->m_data[idx] = result;
+            s.m_size++;
+            if (2 * s.m_size > t->m_capacity)
+                expand(s);
         }
+        omp_unset_lock(&s.m_lock);
+        SASSERT(get_hash(result) == h && strcmp(result, d) == 0);
         return result;
     }
 };
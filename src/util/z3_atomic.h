@@ -0,0 +1,49 @@
+/*++
+Copyright (c) 2014 Microsoft Corporation
+
+Module Name:
+
+    z3_atomic.h
+
+Abstract:
+
+    Wrapper for atomic increment/decrement of unsigned counters,
+    and for a full memory fence.
+
+Author:
+
+Notes:
+
+    When OMP is disabled, there is only one thread and the 
+    plain operations are used.
+
+--*/
+#ifndef _Z3_ATOMIC_H
+#define _Z3_ATOMIC_H
+
+#if defined(_NO_OMP_)
+
+inline unsigned atomic_inc(unsigned volatile * v) { return ++(*v); }
+inline unsigned atomic_dec(unsigned volatile * v) { return --(*v); }
+inline void atomic_fence() {}
+
+#elif defined(_WINDOWS)
+#include<intrin.h>
+
+inline unsigned atomic_inc(unsigned volatile * v) { 
+    return static_cast<unsigned>(_InterlockedIncrement(reinterpret_cast<long volatile *>(v))); 
+}
+inline unsigned atomic_dec(unsigned volatile * v) { 
+    return static_cast<unsigned>(_InterlockedDecrement(reinterpret_cast<long volatile *>(v))); 
+}
+inline void atomic_fence() { _ReadWriteBarrier(); _mm_mfence(); }
+
+#else
+
+inline unsigned atomic_inc(unsigned volatile * v) { return __sync_add_and_fetch(v, 1u); }
+inline unsigned atomic_dec(unsigned volatile * v) { return __sync_sub_and_fetch(v, 1u); }
+inline void atomic_fence() { __sync_synchronize(); }
+
+#endif
+
+#endif
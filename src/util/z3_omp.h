@@ -31,8 +31,14 @@ Notes:
 #define omp_destroy_nest_lock(L) ((void) 0)
 #define omp_set_nest_lock(L) ((void) 0)
 #define omp_unset_nest_lock(L) ((void) 0)
+#define omp_init_lock(L) ((void) 0)
+#define omp_destroy_lock(L) ((void) 0)
+#define omp_set_lock(L) ((void) 0)
+#define omp_unset_lock(L) ((void) 0)
 struct omp_nest_lock_t {
 };
+struct omp_lock_t {
+};
 #endif
 
 #endif